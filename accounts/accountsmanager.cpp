@@ -46,30 +46,85 @@ AccountsManagerPrivate::~AccountsManagerPrivate()
     delete interface;
 }
 
-void AccountsManagerPrivate::_q_userAdded(const QDBusObjectPath &path)
+UserAccount *AccountsManagerPrivate::accountForPath(const QString &path)
+{
+    UserAccount *account = usersCache.value(path, nullptr);
+    if (!account) {
+        account = new UserAccount(path, interface->connection());
+        usersCache[path] = account;
+    }
+    return account;
+}
+
+UserAccount *AccountsManagerPrivate::cachedUserById(qlonglong uid) const
+{
+    // Accounts Service names its objects after the uid
+    return usersCache.value(QStringLiteral("/org/freedesktop/Accounts/User") + QString::number(uid),
+                            nullptr);
+}
+
+AccountsRequest *AccountsManagerPrivate::lookup(
+    const QString &key, const std::function<QDBusPendingReply<QDBusObjectPath>()> &call)
 {
     Q_Q(AccountsManager);
 
-    if (usersCache.contains(path.path())) {
-        Q_EMIT q->userAdded(usersCache[path.path()]);
-        return;
+    AccountsRequest *request = new AccountsRequest(q);
+
+    auto it = pendingLookups.find(key);
+    if (it != pendingLookups.end()) {
+        // Same lookup already in flight, share its reply
+        it.value().append(request);
+        return request;
     }
+    pendingLookups[key].append(request);
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call(), q);
+    q->connect(watcher, &QDBusPendingCallWatcher::finished, q, [this, key](QDBusPendingCallWatcher *w) {
+        QDBusPendingReply<QDBusObjectPath> reply = *w;
+        w->deleteLater();
+
+        const QList<QPointer<AccountsRequest>> requests = pendingLookups.take(key);
+
+        UserAccount *account = nullptr;
+        QString errorMessage;
+        if (reply.isError()) {
+            QDBusError error = reply.error();
+            errorMessage = error.message().isEmpty() ? error.errorString(error.type())
+                                                     : error.message();
+            qWarning("Couldn't complete %s: %s", key.toUtf8().constData(),
+                     errorMessage.toUtf8().constData());
+        } else if (!reply.argumentAt<0>().path().isEmpty()) {
+            account = accountForPath(reply.argumentAt<0>().path());
+        }
+
+        for (const auto &request : requests) {
+            if (request)
+                request->finish(account, errorMessage);
+        }
+    });
+
+    return request;
+}
 
-    UserAccount *account = new UserAccount(path.path(), interface->connection());
-    usersCache[path.path()] = account;
-    Q_EMIT q->userAdded(account);
+void AccountsManagerPrivate::_q_userAdded(const QDBusObjectPath &path)
+{
+    Q_Q(AccountsManager);
+
+    Q_EMIT q->userAdded(accountForPath(path.path()));
 }
 
 void AccountsManagerPrivate::_q_userDeleted(const QDBusObjectPath &path)
 {
     Q_Q(AccountsManager);
 
-    UserAccount *account = usersCache.value(path.path(), nullptr);
-    if (!account)
-        account = new UserAccount(path.path());
-    usersCache.remove(path.path());
-    Q_EMIT q->userDeleted(account->userId());
-    account->deleteLater();
+    // The user is gone, so take the uid from the object path rather than
+    // asking Accounts Service about it
+    const qlonglong uid = path.path().section(QStringLiteral("/User"), -1).toLongLong();
+
+    UserAccount *account = usersCache.take(path.path());
+    Q_EMIT q->userDeleted(uid);
+    if (account)
+        account->deleteLater();
 }
 
 /*!
@@ -137,11 +192,7 @@ void AccountsManager::cacheUser(const QString &userName)
             if (path.path().isEmpty())
                 return;
 
-            UserAccount *account = d->usersCache.value(path.path(), nullptr);
-            if (!account) {
-                account = new UserAccount(path.path(), d->interface->connection());
-                d->usersCache[path.path()] = account;
-            }
+            d->accountForPath(path.path());
             Q_EMIT userCached(userName);
         }
     });
@@ -174,7 +225,7 @@ void AccountsManager::uncacheUser(const QString &userName)
             while (it != d->usersCache.end()) {
                 auto account = it.value();
                 if (account->userName() == userName) {
-                    d->usersCache.erase(++it);
+                    it = d->usersCache.erase(it);
                     account->deleteLater();
                 } else {
                     ++it;
@@ -209,12 +260,7 @@ void AccountsManager::listCachedUsers()
             userList.reserve(value.size());
             for (int i = 0; i < value.size(); i++) {
                 const QString path = value.at(i).path();
-                UserAccount *account = d->usersCache.value(path, nullptr);
-                if (!account) {
-                    account = new UserAccount(path, d->interface->connection());
-                    d->usersCache[path] = account;
-                }
-                userList.append(account);
+                userList.append(d->accountForPath(path));
             }
             Q_EMIT listCachedUsersFinished(userList);
         }
@@ -249,12 +295,7 @@ UserAccountList AccountsManager::listCachedUsersSync()
 
     for (int i = 0; i < value.size(); i++) {
         const QString path = value.at(i).path();
-        UserAccount *account = d->usersCache.value(path, nullptr);
-        if (!account) {
-            account = new UserAccount(path, d->interface->connection());
-            d->usersCache[path] = account;
-        }
-        list.append(account);
+        list.append(d->accountForPath(path));
     }
 
     return list;
@@ -276,6 +317,7 @@ UserAccount *AccountsManager::cachedUser(const QString &userName) const
         auto account = it.value();
         if (account->userName() == userName)
             return account;
+        ++it;
     }
 
     return nullptr;
@@ -293,6 +335,9 @@ UserAccount *AccountsManager::findUserById(qlonglong uid)
 {
     Q_D(AccountsManager);
 
+    if (UserAccount *account = d->cachedUserById(uid))
+        return account;
+
     QDBusPendingReply<QDBusObjectPath> reply = d->interface->FindUserById(uid);
     reply.waitForFinished();
 
@@ -307,12 +352,7 @@ UserAccount *AccountsManager::findUserById(qlonglong uid)
     if (path.path().isEmpty())
         return nullptr;
 
-    UserAccount *account = d->usersCache.value(path.path(), nullptr);
-    if (!account) {
-        account = new UserAccount(path.path(), d->interface->connection());
-        d->usersCache[path.path()] = account;
-    }
-    return account;
+    return d->accountForPath(path.path());
 }
 
 /*!
@@ -341,12 +381,7 @@ UserAccount *AccountsManager::findUserByName(const QString &userName)
     if (path.path().isEmpty())
         return nullptr;
 
-    UserAccount *account = d->usersCache.value(path.path(), nullptr);
-    if (!account) {
-        account = new UserAccount(path.path(), d->interface->connection());
-        d->usersCache[path.path()] = account;
-    }
-    return account;
+    return d->accountForPath(path.path());
 }
 
 /*!
@@ -414,6 +449,113 @@ bool AccountsManager::deleteUser(UserAccount *account, bool removeFiles)
 {
     return deleteUser(account->userId(), removeFiles);
 }
+
+/*!
+    Finds a user by \a uid asynchronously.
+
+    Accounts already known to this manager are returned without a
+    D-Bus call, concurrent lookups of the same uid share one call.
+
+    \param uid The uid to look up.
+    \return a request whose account is set when finished.
+*/
+AccountsRequest *AccountsManager::findUserByIdAsync(qlonglong uid)
+{
+    Q_D(AccountsManager);
+
+    if (UserAccount *account = d->cachedUserById(uid)) {
+        AccountsRequest *request = new AccountsRequest(this);
+        request->finishLater(account);
+        return request;
+    }
+
+    return d->lookup(QStringLiteral("FindUserById:") + QString::number(uid),
+                     [d, uid]() { return d->interface->FindUserById(uid); });
+}
+
+/*!
+    Finds a user by user \a userName asynchronously.
+
+    Accounts already known to this manager are returned without a
+    D-Bus call, concurrent lookups of the same name share one call.
+
+    \param userName The user name to look up.
+    \return a request whose account is set when finished.
+*/
+AccountsRequest *AccountsManager::findUserByNameAsync(const QString &userName)
+{
+    Q_D(AccountsManager);
+
+    if (UserAccount *account = cachedUser(userName)) {
+        AccountsRequest *request = new AccountsRequest(this);
+        request->finishLater(account);
+        return request;
+    }
+
+    return d->lookup(QStringLiteral("FindUserByName:") + userName,
+                     [d, userName]() { return d->interface->FindUserByName(userName); });
+}
+
+/*!
+    Creates a new \a accountType type user account whose name is \a userName,
+    real name is \a fullName, without blocking.
+
+    \param userName The name of the new user to be created.
+    \param fullName First name and last name.
+    \param accountType The account type.
+    \return a request whose account is the new user when finished.
+*/
+AccountsRequest *AccountsManager::createUserAsync(const QString &userName,
+                                                  const QString &fullName,
+                                                  UserAccount::AccountType accountType)
+{
+    Q_D(AccountsManager);
+
+    // Only identical calls may share a reply, a different full name or
+    // account type gets its own CreateUser call
+    const QString key = QStringLiteral("CreateUser:%1:%2:%3")
+                            .arg(QString::number(accountType), userName, fullName);
+    return d->lookup(key,
+                     [d, userName, fullName, accountType]() {
+                         return d->interface->CreateUser(userName, fullName, accountType);
+                     });
+}
+
+/*!
+    Deletes the user designated by \a uid without blocking.
+
+    \param uid The user identifier.
+    \param removeFiles If true all files owned by the user will be removed.
+    \return a request that finishes when the user was deleted.
+*/
+AccountsRequest *AccountsManager::deleteUserAsync(qlonglong uid, bool removeFiles)
+{
+    Q_D(AccountsManager);
+
+    AccountsRequest *request = new AccountsRequest(this);
+
+    QDBusPendingCallWatcher *watcher =
+        new QDBusPendingCallWatcher(d->interface->DeleteUser(uid, removeFiles), this);
+    QPointer<AccountsRequest> guard(request);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [uid, guard](QDBusPendingCallWatcher *w) {
+        QDBusPendingReply<> reply = *w;
+        w->deleteLater();
+        if (!guard)
+            return;
+
+        if (reply.isError()) {
+            QDBusError error = reply.error();
+            qWarning("Couldn't delete user %lld: %s", uid,
+                     error.errorString(error.type()).toUtf8().constData());
+            guard->finish(nullptr, error.message().isEmpty() ? error.errorString(error.type())
+                                                             : error.message());
+        } else {
+            guard->finish(nullptr);
+        }
+    });
+
+    return request;
+}
 }
 
 #include "moc_accountsmanager.cpp"
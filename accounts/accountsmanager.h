@@ -27,6 +27,7 @@
 #include <QtCore/QObject>
 #include <QtDBus/QDBusConnection>
 
+#include "accountsrequest.h"
 #include "useraccount.h"
 
 QT_FORWARD_DECLARE_CLASS(QDBusObjectPath)
@@ -54,12 +55,20 @@ public:
     Q_INVOKABLE QtAccountsService::UserAccount *findUserById(qlonglong uid);
     Q_INVOKABLE QtAccountsService::UserAccount *findUserByName(const QString &userName);
 
+    Q_INVOKABLE QtAccountsService::AccountsRequest *findUserByIdAsync(qlonglong uid);
+    Q_INVOKABLE QtAccountsService::AccountsRequest *findUserByNameAsync(const QString &userName);
+
     Q_INVOKABLE bool createUser(const QString &userName, const QString &fullName,
                                 UserAccount::AccountType accountType);
 
     Q_INVOKABLE bool deleteUser(qlonglong uid, bool removeFiles);
     bool deleteUser(UserAccount *account, bool removeFiles);
 
+    Q_INVOKABLE QtAccountsService::AccountsRequest *createUserAsync(const QString &userName,
+                                                                    const QString &fullName,
+                                                                    UserAccount::AccountType accountType);
+    Q_INVOKABLE QtAccountsService::AccountsRequest *deleteUserAsync(qlonglong uid, bool removeFiles);
+
 Q_SIGNALS:
     void userAdded(QtAccountsService::UserAccount *account);
     void userDeleted(qlonglong uid);
@@ -26,6 +26,11 @@
 
 #include "accounts_interface.h"
 
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
+
+#include <functional>
+
 //
 //  W A R N I N G
 //  -------------
@@ -42,6 +47,7 @@ class OrgFreedesktopAccountsInterface;
 namespace QtAccountsService {
 
 class AccountsManager;
+class AccountsRequest;
 
 class AccountsManagerPrivate
 {
@@ -53,6 +59,13 @@ public:
     AccountsManager *q_ptr;
     OrgFreedesktopAccountsInterface *interface;
     QMap<QString, UserAccount *> usersCache;
+    // Requests waiting on the same lookup, by lookup key
+    QHash<QString, QList<QPointer<AccountsRequest>>> pendingLookups;
+
+    UserAccount *accountForPath(const QString &path);
+    UserAccount *cachedUserById(qlonglong uid) const;
+    AccountsRequest *lookup(const QString &key,
+                            const std::function<QDBusPendingReply<QDBusObjectPath>()> &call);
 
     void _q_userAdded(const QDBusObjectPath &path);
     void _q_userDeleted(const QDBusObjectPath &path);
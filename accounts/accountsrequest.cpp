@@ -0,0 +1,135 @@
+/****************************************************************************
+ * This file is part of Qt AccountsService.
+ *
+ * Copyright (C) 2018 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include "accountsrequest.h"
+#include "useraccount.h"
+
+#include <QtCore/QPointer>
+
+namespace QtAccountsService {
+
+/*!
+    \class AccountsRequest
+    \brief The AccountsRequest class tracks an asynchronous AccountsManager call.
+
+    Requests are returned by the asynchronous AccountsManager methods.
+    The finished() signal is always emitted from the event loop, never
+    from the method that created the request, so it is safe to connect
+    to it after the call. The request deletes itself after finished()
+    or canceled() has been emitted.
+
+    \sa AccountsManager
+*/
+
+AccountsRequest::AccountsRequest(QObject *parent)
+    : QObject(parent)
+    , m_finished(false)
+    , m_canceled(false)
+    , m_account(nullptr)
+{
+}
+
+/*!
+    Returns whether the call finished.
+*/
+bool AccountsRequest::isFinished() const
+{
+    return m_finished;
+}
+
+/*!
+    Returns whether the request was canceled.
+*/
+bool AccountsRequest::isCanceled() const
+{
+    return m_canceled;
+}
+
+/*!
+    Returns whether the call failed.
+*/
+bool AccountsRequest::isError() const
+{
+    return !m_errorMessage.isEmpty();
+}
+
+/*!
+    Returns the error message if the call failed.
+*/
+QString AccountsRequest::errorMessage() const
+{
+    return m_errorMessage;
+}
+
+/*!
+    Returns the user account the call resolved to, if any.
+*/
+UserAccount *AccountsRequest::account() const
+{
+    return m_account;
+}
+
+/*!
+    Cancels the request, finished() won't be emitted.
+
+    Accounts Service can't abort a call in flight, its result is
+    simply dropped.
+*/
+void AccountsRequest::cancel()
+{
+    if (m_finished || m_canceled)
+        return;
+
+    m_canceled = true;
+    Q_EMIT canceled();
+    deleteLater();
+}
+
+/*!
+    \internal
+*/
+void AccountsRequest::finish(UserAccount *account, const QString &errorMessage)
+{
+    if (m_finished || m_canceled)
+        return;
+
+    m_finished = true;
+    m_account = account;
+    m_errorMessage = errorMessage;
+    Q_EMIT finished();
+    deleteLater();
+}
+
+/*!
+    \internal
+*/
+void AccountsRequest::finishLater(UserAccount *account, const QString &errorMessage)
+{
+    QPointer<UserAccount> guard(account);
+    QMetaObject::invokeMethod(this, [this, guard, errorMessage]() {
+        finish(guard.data(), errorMessage);
+    }, Qt::QueuedConnection);
+}
+}
+
+#include "moc_accountsrequest.cpp"
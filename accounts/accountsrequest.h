@@ -0,0 +1,74 @@
+/****************************************************************************
+ * This file is part of Qt AccountsService.
+ *
+ * Copyright (C) 2018 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef QTACCOUNTSSERVICE_ACCOUNTSREQUEST_H
+#define QTACCOUNTSSERVICE_ACCOUNTSREQUEST_H
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+namespace QtAccountsService {
+
+class AccountsManager;
+class AccountsManagerPrivate;
+class UserAccount;
+
+class AccountsRequest : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool isFinished READ isFinished NOTIFY finished)
+    Q_PROPERTY(bool isCanceled READ isCanceled NOTIFY canceled)
+    Q_PROPERTY(bool error READ isError NOTIFY finished)
+    Q_PROPERTY(QString errorMessage READ errorMessage NOTIFY finished)
+    Q_PROPERTY(QtAccountsService::UserAccount *account READ account NOTIFY finished)
+public:
+    bool isFinished() const;
+    bool isCanceled() const;
+    bool isError() const;
+    QString errorMessage() const;
+
+    UserAccount *account() const;
+
+    Q_INVOKABLE void cancel();
+
+Q_SIGNALS:
+    void finished();
+    void canceled();
+
+private:
+    friend class AccountsManager;
+    friend class AccountsManagerPrivate;
+
+    explicit AccountsRequest(QObject *parent = nullptr);
+
+    void finish(UserAccount *account, const QString &errorMessage = QString());
+    void finishLater(UserAccount *account, const QString &errorMessage = QString());
+
+    bool m_finished;
+    bool m_canceled;
+    QString m_errorMessage;
+    UserAccount *m_account;
+};
+}
+
+#endif // QTACCOUNTSSERVICE_ACCOUNTSREQUEST_H
@@ -0,0 +1,215 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2018 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+#include <QtGui/QImageReader>
+
+#include "avatarcache.h"
+
+namespace QtAccountsService {
+
+// Cache budget, in KiB
+static const int avatarCacheCost = 8 * 1024;
+
+class AvatarLoader : public QRunnable
+{
+public:
+    AvatarLoader(const QString &cacheKey, const QString &fileName, const QSize &size)
+        : m_cacheKey(cacheKey)
+        , m_fileName(fileName)
+        , m_size(size)
+    {
+    }
+
+    void run() override
+    {
+        AvatarCache::instance()->decode(m_cacheKey, m_fileName, m_size);
+    }
+
+private:
+    QString m_cacheKey;
+    QString m_fileName;
+    QSize m_size;
+};
+
+AvatarCache::AvatarCache(QObject *parent)
+    : QObject(parent)
+{
+    m_images.setMaxCost(avatarCacheCost);
+}
+
+AvatarCache *AvatarCache::instance()
+{
+    static AvatarCache cache;
+    return &cache;
+}
+
+QImage AvatarCache::image(const QString &fileName, const QSize &size)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const QImage *cached = m_images.object(key(fileName, size));
+    return cached ? *cached : QImage();
+}
+
+void AvatarCache::request(const QString &fileName, const QSize &size)
+{
+    QString cacheKey;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        cacheKey = key(fileName, size);
+        if (m_images.contains(cacheKey) || m_pending.contains(cacheKey)
+            || m_failed.contains(cacheKey))
+            return;
+        m_pending.insert(cacheKey, QVector<Waiter>());
+    }
+
+    QThreadPool::globalInstance()->start(new AvatarLoader(cacheKey, fileName, size));
+}
+
+QString AvatarCache::fetch(const QString &fileName, const QSize &size, QObject *receiver,
+                           const std::function<void(const QImage &)> &callback)
+{
+    QString cacheKey;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        cacheKey = key(fileName, size);
+        const QImage *cached = m_images.object(cacheKey);
+        if (cached || m_failed.contains(cacheKey)) {
+            // Still queued, so the callback never runs before fetch() returned
+            const QImage image = cached ? *cached : QImage();
+            QMetaObject::invokeMethod(receiver, [callback, image]() { callback(image); },
+                                      Qt::QueuedConnection);
+            return cacheKey;
+        }
+
+        auto it = m_pending.find(cacheKey);
+        const bool running = it != m_pending.end();
+        if (!running)
+            it = m_pending.insert(cacheKey, QVector<Waiter>());
+        it->append({ receiver, callback });
+        if (running)
+            return cacheKey;
+    }
+
+    QThreadPool::globalInstance()->start(new AvatarLoader(cacheKey, fileName, size));
+    return cacheKey;
+}
+
+void AvatarCache::cancel(const QString &key, QObject *receiver)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_pending.find(key);
+    if (it == m_pending.end())
+        return;
+
+    for (int i = 0; i < it->size(); i++) {
+        if (it->at(i).receiver == receiver) {
+            it->remove(i);
+            break;
+        }
+    }
+}
+
+void AvatarCache::decode(const QString &cacheKey, const QString &fileName, const QSize &size)
+{
+    QImageReader reader(fileName);
+    const QSize sourceSize = reader.size();
+    if (sourceSize.isValid() && size.isValid()
+        && (sourceSize.width() > size.width() || sourceSize.height() > size.height()))
+        reader.setScaledSize(sourceSize.scaled(size, Qt::KeepAspectRatioByExpanding));
+
+    QImage image;
+    if (!reader.read(&image))
+        qWarning("Couldn't load user picture %s: %s", fileName.toUtf8().constData(),
+                 reader.errorString().toUtf8().constData());
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (image.isNull()) {
+            // Not retried until the file changes, the key includes its stamp
+            m_failed.insert(cacheKey);
+        } else {
+            m_images.insert(cacheKey, new QImage(image),
+                            qMax(1, int(image.sizeInBytes() / 1024)));
+        }
+
+        // Receivers cancel under the same lock before they are destroyed,
+        // so all of them are still alive here. A queued call is dropped if
+        // its receiver is destroyed before it is delivered.
+        const QVector<Waiter> waiters = m_pending.take(cacheKey);
+        for (const Waiter &waiter : waiters) {
+            const auto callback = waiter.callback;
+            QMetaObject::invokeMethod(waiter.receiver, [callback, image]() { callback(image); },
+                                      Qt::QueuedConnection);
+        }
+    }
+
+    if (!image.isNull())
+        Q_EMIT imageLoaded(fileName);
+}
+
+void AvatarCache::invalidate(const QString &fileName)
+{
+    QMutexLocker locker(&m_mutex);
+    m_stamps.remove(fileName);
+
+    const QString prefix = fileName + QLatin1Char('@');
+    for (auto it = m_failed.begin(); it != m_failed.end();) {
+        if (it->startsWith(prefix))
+            it = m_failed.erase(it);
+        else
+            ++it;
+    }
+}
+
+qint64 AvatarCache::stamp(const QString &fileName)
+{
+    QMutexLocker locker(&m_mutex);
+    return stampLocked(fileName);
+}
+
+QString AvatarCache::key(const QString &fileName, const QSize &size)
+{
+    return fileName + QLatin1Char('@') + QString::number(stampLocked(fileName))
+        + QLatin1Char('/') + QString::number(size.width())
+        + QLatin1Char('x') + QString::number(size.height());
+}
+
+qint64 AvatarCache::stampLocked(const QString &fileName)
+{
+    auto it = m_stamps.find(fileName);
+    if (it == m_stamps.end())
+        it = m_stamps.insert(fileName, QFileInfo(fileName).lastModified().toMSecsSinceEpoch());
+    return it.value();
+}
+}
+
+#include "moc_avatarcache.cpp"
@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2018 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef QTACCOUNTSSERVICE_AVATARCACHE_H
+#define QTACCOUNTSSERVICE_AVATARCACHE_H
+
+#include <QtCore/QCache>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+#include <QtCore/QSize>
+#include <QtCore/QVector>
+#include <QtGui/QImage>
+
+#include <functional>
+
+namespace QtAccountsService {
+
+/*
+ * Process wide cache of downscaled user pictures.
+ *
+ * Entries are keyed by file name, modification time and size, so a
+ * picture replaced on disk is decoded again. The modification time is
+ * remembered per file until invalidate() is called, lookups don't stat.
+ * Pictures that fail to decode are remembered the same way and not
+ * requested again, imageLoaded() is only emitted for decoded pictures.
+ */
+class AvatarCache : public QObject
+{
+    Q_OBJECT
+public:
+    static AvatarCache *instance();
+
+    // Returns the cached picture, or a null image if it isn't decoded yet
+    QImage image(const QString &fileName, const QSize &size);
+
+    // Decodes the picture into the cache from the thread pool
+    void request(const QString &fileName, const QSize &size);
+
+    // Calls callback in the thread of receiver with the picture, or a null
+    // image if it can't be decoded. Joins the decode already running for
+    // it, if any. Returns the key to cancel() with, thread safe.
+    QString fetch(const QString &fileName, const QSize &size, QObject *receiver,
+                  const std::function<void(const QImage &)> &callback);
+
+    // Drops the callback of receiver, it must not be destroyed before
+    void cancel(const QString &key, QObject *receiver);
+
+    // Forget the modification time of fileName, it gets checked again
+    void invalidate(const QString &fileName);
+
+    // Token that changes whenever fileName changes on disk
+    qint64 stamp(const QString &fileName);
+
+Q_SIGNALS:
+    void imageLoaded(const QString &fileName);
+
+private:
+    struct Waiter {
+        QObject *receiver;
+        std::function<void(const QImage &)> callback;
+    };
+
+    friend class AvatarLoader;
+
+    explicit AvatarCache(QObject *parent = nullptr);
+
+    QString key(const QString &fileName, const QSize &size);
+    qint64 stampLocked(const QString &fileName);
+    void decode(const QString &cacheKey, const QString &fileName, const QSize &size);
+
+    QMutex m_mutex;
+    QCache<QString, QImage> m_images;
+    QHash<QString, qint64> m_stamps;
+    // Running decodes and who waits for them
+    QHash<QString, QVector<Waiter>> m_pending;
+    QSet<QString> m_failed;
+};
+}
+
+#endif // QTACCOUNTSSERVICE_AVATARCACHE_H
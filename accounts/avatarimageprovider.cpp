@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2018 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtCore/QUrl>
+
+#include "avatarcache.h"
+#include "avatarimageprovider.h"
+
+namespace QtAccountsService {
+
+// Size used when the Image doesn't set a sourceSize
+static const int defaultAvatarSize = 256;
+
+const QString AvatarImageProvider::providerId = QStringLiteral("useravatar");
+
+namespace {
+
+// Handed to the engine, which may delete it at any time. It never runs
+// on the pool, the cache posts the decoded picture to it instead.
+class AvatarResponse : public QQuickImageResponse
+{
+public:
+    AvatarResponse(const QString &fileName, const QSize &size)
+    {
+        m_cacheKey = AvatarCache::instance()->fetch(fileName, size, this,
+                                                    [this](const QImage &image) {
+                                                        m_image = image;
+                                                        Q_EMIT finished();
+                                                    });
+    }
+
+    ~AvatarResponse() override
+    {
+        AvatarCache::instance()->cancel(m_cacheKey, this);
+    }
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(m_image);
+    }
+
+private:
+    QString m_cacheKey;
+    QImage m_image;
+};
+}
+
+AvatarImageProvider::AvatarImageProvider()
+    : QQuickAsyncImageProvider()
+{
+}
+
+QQuickImageResponse *AvatarImageProvider::requestImageResponse(const QString &id,
+                                                               const QSize &requestedSize)
+{
+    // The stamp only makes the URL change along with the file
+    const QString fileName = QUrl::fromPercentEncoding(id.section(QLatin1Char('/'), 1).toUtf8());
+
+    QSize size = requestedSize;
+    if (size.width() <= 0 && size.height() <= 0)
+        size = QSize(defaultAvatarSize, defaultAvatarSize);
+    else if (size.width() <= 0)
+        size.setWidth(size.height());
+    else if (size.height() <= 0)
+        size.setHeight(size.width());
+
+    // Views and the users model asking for the same picture share one decode
+    return new AvatarResponse(fileName, size);
+}
+
+QString AvatarImageProvider::imageSource(const QString &fileName)
+{
+    if (fileName.isEmpty())
+        return QString();
+
+    return QStringLiteral("image://") + providerId + QLatin1Char('/')
+        + QString::number(AvatarCache::instance()->stamp(fileName)) + QLatin1Char('/')
+        + QString::fromLatin1(QUrl::toPercentEncoding(fileName));
+}
+}
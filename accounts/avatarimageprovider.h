@@ -0,0 +1,47 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2018 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef QTACCOUNTSSERVICE_AVATARIMAGEPROVIDER_H
+#define QTACCOUNTSSERVICE_AVATARIMAGEPROVIDER_H
+
+#include <QtQuick/QQuickAsyncImageProvider>
+
+namespace QtAccountsService {
+
+/*
+ * Serves user pictures as "image://useravatar/<stamp>/<percent encoded file name>"
+ * from the AvatarCache, decoding them in the thread pool.
+ */
+class AvatarImageProvider : public QQuickAsyncImageProvider
+{
+public:
+    static const QString providerId;
+
+    AvatarImageProvider();
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+    static QString imageSource(const QString &fileName);
+};
+}
+
+#endif // QTACCOUNTSSERVICE_AVATARIMAGEPROVIDER_H
@@ -0,0 +1,134 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2018 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtCore/QDeadlineTimer>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+
+#include "nsscache_p.h"
+
+#include <errno.h>
+#include <pwd.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace QtAccountsService {
+namespace NssCache {
+
+static const int positiveTtl = 60 * 1000;
+static const int negativeTtl = 5 * 1000;
+
+template<typename Entry>
+struct Cached
+{
+    Entry entry;
+    QDeadlineTimer deadline;
+};
+
+struct Cache
+{
+    QMutex mutex;
+    QHash<qlonglong, Cached<PasswdEntry>> passwdByUid;
+};
+
+Q_GLOBAL_STATIC(Cache, cache)
+
+static QByteArray &scratchBuffer()
+{
+    static thread_local QByteArray buffer;
+    if (buffer.isEmpty()) {
+        const long sizeMax = ::sysconf(_SC_GETPW_R_SIZE_MAX);
+        buffer.resize(sizeMax > 0 ? static_cast<int>(sizeMax) : 16384);
+    }
+    return buffer;
+}
+
+template<typename Key, typename Entry>
+static bool findCached(const QHash<Key, Cached<Entry>> &hash, const Key &key, Entry *entry)
+{
+    const auto it = hash.constFind(key);
+    if (it == hash.constEnd() || it->deadline.hasExpired())
+        return false;
+
+    *entry = it->entry;
+    return true;
+}
+
+template<typename Entry>
+static Cached<Entry> makeCached(const Entry &entry)
+{
+    return Cached<Entry> { entry, QDeadlineTimer(entry.found ? positiveTtl : negativeTtl) };
+}
+
+static PasswdEntry fromPasswd(const struct passwd &pwd)
+{
+    PasswdEntry entry;
+    entry.found = true;
+    entry.uid = pwd.pw_uid;
+    entry.gid = pwd.pw_gid;
+    return entry;
+}
+
+// Runs a reentrant lookup, growing the scratch buffer while it's too small
+template<typename Struct, typename Lookup>
+static bool lookup(Struct *result, Lookup call)
+{
+    QByteArray &buffer = scratchBuffer();
+    Struct *found = nullptr;
+
+    for (;;) {
+        const int error = call(result, buffer.data(), static_cast<size_t>(buffer.size()), &found);
+        if (error == ERANGE) {
+            buffer.resize(buffer.size() * 2);
+            continue;
+        }
+        if (error != 0 && error != ENOENT)
+            qWarning("NSS lookup failed: %s", strerror(error));
+        return found != nullptr;
+    }
+}
+
+PasswdEntry passwdByUid(qlonglong uid)
+{
+    PasswdEntry entry;
+    {
+        QMutexLocker locker(&cache()->mutex);
+        if (findCached(cache()->passwdByUid, uid, &entry))
+            return entry;
+    }
+
+    struct passwd pwd;
+    if (lookup(&pwd,
+               [uid](struct passwd *p, char *buf, size_t size, struct passwd **found) {
+                   return ::getpwuid_r(static_cast<uid_t>(uid), p, buf, size, found);
+               }))
+        entry = fromPasswd(pwd);
+    else
+        entry.uid = uid;
+
+    QMutexLocker locker(&cache()->mutex);
+    cache()->passwdByUid.insert(uid, makeCached(entry));
+    return entry;
+}
+}
+}
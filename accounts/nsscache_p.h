@@ -0,0 +1,63 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2018 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef QTACCOUNTSSERVICE_NSSCACHE_P_H
+#define QTACCOUNTSSERVICE_NSSCACHE_P_H
+
+#include <QtCore/QtGlobal>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt AccountsService API.  It exists
+// purely as an implementation detail.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+namespace QtAccountsService {
+
+/*
+ * Caches passwd lookups, which may go to the network on LDAP or SSSD
+ * backed machines.
+ *
+ * Entries expire after a while, so changes made behind our back are
+ * eventually picked up. Misses are cached too, for a shorter time.
+ * The reentrant NSS call uses a per thread scratch buffer that is only
+ * ever grown, so a lookup doesn't allocate once it's warm.
+ */
+namespace NssCache {
+
+struct PasswdEntry
+{
+    bool found = false;
+    qlonglong uid = -1;
+    qlonglong gid = -1;
+};
+
+PasswdEntry passwdByUid(qlonglong uid);
+}
+}
+
+#endif // QTACCOUNTSSERVICE_NSSCACHE_P_H
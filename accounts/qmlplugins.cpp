@@ -2,6 +2,8 @@
 #include <QQmlEngine>
 
 #include "accountsmanager.h"
+#include "accountsrequest.h"
+#include "avatarimageprovider.h"
 #include "useraccount.h"
 #include "usersmodel.h"
 
@@ -15,6 +17,14 @@ public:
         qmlRegisterType<QtAccountsService::AccountsManager>(uri, 1, 0, "AccountsManager");
         qmlRegisterType<QtAccountsService::UserAccount>(uri, 1, 0, "UserAccount");
         qmlRegisterType<QtAccountsService::UsersModel>(uri, 1, 0, "UsersModel");
+        qmlRegisterUncreatableType<QtAccountsService::AccountsRequest>(uri, 1, 0, "AccountsRequest",
+                                                                       QStringLiteral("Returned by AccountsManager"));
+    }
+
+    void initializeEngine(QQmlEngine *engine, const char *uri) override {
+        Q_UNUSED(uri)
+        engine->addImageProvider(QtAccountsService::AvatarImageProvider::providerId,
+                                 new QtAccountsService::AvatarImageProvider);
     }
 };
 
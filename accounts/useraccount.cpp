@@ -22,10 +22,15 @@
 
 #include "useraccount.h"
 #include "useraccount_p.h"
+#include "nsscache_p.h"
+
+#include <QtCore/QFile>
+#include <QtDBus/QDBusMessage>
+#include <QtDBus/QDBusPendingCallWatcher>
+#include <QtDBus/QDBusPendingReply>
 
 #include <sys/types.h>
 #include <unistd.h>
-#include <pwd.h>
 
 namespace QtAccountsService {
 
@@ -36,10 +41,18 @@ namespace QtAccountsService {
 UserAccountPrivate::UserAccountPrivate(UserAccount *q)
     : bus(QDBusConnection::systemBus())
     , user(nullptr)
+    , propertiesWatcher(nullptr)
+    , propertiesDirty(false)
+    , uid(-1)
     , accountType(UserAccount::StandardAccountType)
     , locked(false)
     , automaticLogin(false)
+    , loginFrequency(0)
+    , loginTime(0)
     , passwordMode(UserAccount::NonePasswordMode)
+    , localAccount(false)
+    , systemAccount(false)
+    , iconFileExists(false)
     , q_ptr(q)
 {
 }
@@ -53,37 +66,165 @@ void UserAccountPrivate::initialize(const QDBusConnection &connection, const QSt
     if (user) {
         q->disconnect(user, &OrgFreedesktopAccountsUserInterface::Changed, q,
                       &UserAccount::handleAccountChanged);
+        user->deleteLater();
         user = nullptr;
     }
 
+    delete propertiesWatcher;
+    propertiesWatcher = nullptr;
+    propertiesDirty = false;
+
     user = new OrgFreedesktopAccountsUserInterface(QStringLiteral("org.freedesktop.Accounts"),
                                                    objectPath, bus, q);
     q->connect(user, &OrgFreedesktopAccountsUserInterface::Changed, q,
                &UserAccount::handleAccountChanged);
 
-    emitSignals();
+    fetchProperties();
 }
 
-void UserAccountPrivate::emitSignals()
+void UserAccountPrivate::fetchProperties()
 {
     Q_Q(UserAccount);
 
-    Q_EMIT q->userIdChanged();
-    Q_EMIT q->groupIdChanged();
-    Q_EMIT q->accountTypeChanged();
-    Q_EMIT q->lockedChanged();
-    Q_EMIT q->automaticLoginChanged();
-    Q_EMIT q->passwordModeChanged();
-    Q_EMIT q->userNameChanged();
-    Q_EMIT q->realNameChanged();
-    Q_EMIT q->displayNameChanged();
-    Q_EMIT q->homeDirectoryChanged();
-    Q_EMIT q->shellChanged();
-    Q_EMIT q->iconFileNameChanged();
-    Q_EMIT q->emailChanged();
-    Q_EMIT q->languageChanged();
-    Q_EMIT q->locationChanged();
-    Q_EMIT q->xsessionChanged();
+    if (propertiesWatcher) {
+        // Fetch again once the reply in flight arrived
+        propertiesDirty = true;
+        return;
+    }
+
+    QDBusMessage message = QDBusMessage::createMethodCall(user->service(), user->path(),
+                                                          QStringLiteral("org.freedesktop.DBus.Properties"),
+                                                          QStringLiteral("GetAll"));
+    message << user->interface();
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(bus.asyncCall(message), q);
+    propertiesWatcher = watcher;
+    q->connect(watcher, &QDBusPendingCallWatcher::finished, q, [this, watcher]() {
+        handlePropertiesReply(watcher);
+    });
+}
+
+void UserAccountPrivate::handlePropertiesReply(QDBusPendingCallWatcher *watcher)
+{
+    if (watcher != propertiesWatcher)
+        return;
+
+    propertiesWatcher = nullptr;
+    watcher->deleteLater();
+
+    QDBusPendingReply<QVariantMap> reply = *watcher;
+    if (reply.isError()) {
+        qWarning("Failed to get properties of %s: %s", qPrintable(user->path()),
+                 qPrintable(reply.error().message()));
+    } else {
+        updateProperties(reply.value());
+    }
+
+    if (propertiesDirty) {
+        propertiesDirty = false;
+        fetchProperties();
+    }
+}
+
+template<typename T>
+static bool updateValue(T &value, const QVariantMap &properties, const QString &name)
+{
+    const auto it = properties.constFind(name);
+    if (it == properties.constEnd())
+        return false;
+
+    const T newValue = qvariant_cast<T>(it.value());
+    if (value == newValue)
+        return false;
+
+    value = newValue;
+    return true;
+}
+
+void UserAccountPrivate::updateProperties(const QVariantMap &properties)
+{
+    Q_Q(UserAccount);
+
+    // Apply everything first, so that handlers see a consistent account
+    const bool uidChanged = updateValue(uid, properties, QStringLiteral("Uid"));
+    int type = accountType;
+    const bool accountTypeChanged = updateValue(type, properties, QStringLiteral("AccountType"));
+    accountType = static_cast<UserAccount::AccountType>(type);
+    const bool lockedChanged = updateValue(locked, properties, QStringLiteral("Locked"));
+    const bool automaticLoginChanged = updateValue(automaticLogin, properties, QStringLiteral("AutomaticLogin"));
+    const bool loginFrequencyChanged = updateValue(loginFrequency, properties, QStringLiteral("LoginFrequency"));
+    const bool loginTimeChanged = updateValue(loginTime, properties, QStringLiteral("LoginTime"));
+    int mode = passwordMode;
+    const bool passwordModeChanged = updateValue(mode, properties, QStringLiteral("PasswordMode"));
+    passwordMode = static_cast<UserAccount::PasswordMode>(mode);
+    const bool passwordHintChanged = updateValue(passwordHint, properties, QStringLiteral("PasswordHint"));
+    const bool localAccountChanged = updateValue(localAccount, properties, QStringLiteral("LocalAccount"));
+    const bool systemAccountChanged = updateValue(systemAccount, properties, QStringLiteral("SystemAccount"));
+    const bool userNameChanged = updateValue(userName, properties, QStringLiteral("UserName"));
+    const bool realNameChanged = updateValue(realName, properties, QStringLiteral("RealName"));
+    const bool homeDirectoryChanged = updateValue(homeDirectory, properties, QStringLiteral("HomeDirectory"));
+    const bool shellChanged = updateValue(shell, properties, QStringLiteral("Shell"));
+    bool iconFileNameChanged = updateValue(iconFileName, properties, QStringLiteral("IconFile"));
+    const bool exists = !iconFileName.isEmpty() && QFile::exists(iconFileName);
+    if (iconFileExists != exists) {
+        iconFileExists = exists;
+        iconFileNameChanged = true;
+    }
+    const bool emailChanged = updateValue(email, properties, QStringLiteral("Email"));
+    const bool languageChanged = updateValue(language, properties, QStringLiteral("Language"));
+    const bool locationChanged = updateValue(location, properties, QStringLiteral("Location"));
+    const bool xsessionChanged = updateValue(xsession, properties, QStringLiteral("XSession"));
+
+    if (uidChanged) {
+        Q_EMIT q->userIdChanged();
+        Q_EMIT q->groupIdChanged();
+    }
+    if (accountTypeChanged)
+        Q_EMIT q->accountTypeChanged();
+    if (lockedChanged)
+        Q_EMIT q->lockedChanged();
+    if (automaticLoginChanged)
+        Q_EMIT q->automaticLoginChanged();
+    if (loginFrequencyChanged)
+        Q_EMIT q->loginFrequencyChanged();
+    if (loginTimeChanged)
+        Q_EMIT q->loginTimeChanged();
+    if (passwordModeChanged)
+        Q_EMIT q->passwordModeChanged();
+    if (passwordHintChanged)
+        Q_EMIT q->passwordHintChanged();
+    if (localAccountChanged)
+        Q_EMIT q->localAccountChanged();
+    if (systemAccountChanged)
+        Q_EMIT q->systemAccountChanged();
+    if (userNameChanged)
+        Q_EMIT q->userNameChanged();
+    if (realNameChanged)
+        Q_EMIT q->realNameChanged();
+    if (userNameChanged || realNameChanged)
+        Q_EMIT q->displayNameChanged();
+    if (homeDirectoryChanged)
+        Q_EMIT q->homeDirectoryChanged();
+    if (shellChanged)
+        Q_EMIT q->shellChanged();
+    if (iconFileNameChanged)
+        Q_EMIT q->iconFileNameChanged();
+    if (emailChanged)
+        Q_EMIT q->emailChanged();
+    if (languageChanged)
+        Q_EMIT q->languageChanged();
+    if (locationChanged)
+        Q_EMIT q->locationChanged();
+    if (xsessionChanged)
+        Q_EMIT q->xsessionChanged();
+
+    if (uidChanged || accountTypeChanged || lockedChanged || automaticLoginChanged
+        || loginFrequencyChanged || loginTimeChanged || passwordModeChanged
+        || passwordHintChanged || localAccountChanged || systemAccountChanged || userNameChanged
+        || realNameChanged || homeDirectoryChanged || shellChanged
+        || iconFileNameChanged || emailChanged || languageChanged
+        || locationChanged || xsessionChanged)
+        Q_EMIT q->accountChanged();
 }
 
 /*!
@@ -128,12 +269,13 @@ UserAccount::UserAccount(const QString &objectPath, const QDBusConnection &bus,
 }
 
 /*!
-    Returns the user identifier.
+    Returns the user identifier, or -1 until the account properties
+    were retrieved.
 */
 qlonglong UserAccount::userId() const
 {
     Q_D(const UserAccount);
-    return d->user->uid();
+    return d->uid;
 }
 
 /*!
@@ -153,30 +295,16 @@ void UserAccount::setUserId(qlonglong uid)
 */
 qlonglong UserAccount::groupId() const
 {
-    Q_D(const UserAccount);
+    if (userId() < 0)
+        return 0;
 
-    size_t bufSize = 0;
-    long sizeMax = ::sysconf(_SC_GETPW_R_SIZE_MAX);
-    if (sizeMax <= 0)
-        bufSize = 16384;
-    else
-        bufSize = static_cast<size_t>(sizeMax);
-    char *buf = static_cast<char *>(::malloc(bufSize));
-    if (!buf)
-        qFatal("Cannot allocate %lu bytes: %s", static_cast<long>(bufSize), strerror(errno));
-
-    struct passwd pwd;
-    struct passwd *result;
-    int s = ::getpwuid_r(d->user->uid(), &pwd, buf, bufSize, &result);
-    if (!result) {
-        if (s == 0)
-            qCritical("User with uid %lld not found", d->user->uid());
-        else
-            qCritical("Failed to get group information: %s", strerror(s));
+    const NssCache::PasswdEntry entry = NssCache::passwdByUid(userId());
+    if (!entry.found) {
+        qCritical("User with uid %lld not found", userId());
         return 0;
     }
 
-    return pwd.pw_gid;
+    return entry.gid;
 }
 
 /*!
@@ -185,7 +313,7 @@ qlonglong UserAccount::groupId() const
 UserAccount::AccountType UserAccount::accountType() const
 {
     Q_D(const UserAccount);
-    return static_cast<UserAccount::AccountType>(d->user->accountType());
+    return d->accountType;
 }
 
 /*!
@@ -211,7 +339,7 @@ void UserAccount::setAccountType(AccountType type)
 bool UserAccount::isLocked() const
 {
     Q_D(const UserAccount);
-    return d->user->locked();
+    return d->locked;
 }
 
 /*!
@@ -239,7 +367,7 @@ void UserAccount::setLocked(bool locked)
 bool UserAccount::automaticLogin() const
 {
     Q_D(const UserAccount);
-    return d->user->automaticLogin();
+    return d->automaticLogin;
 }
 
 /*!
@@ -266,7 +394,7 @@ void UserAccount::setAutomaticLogin(bool automaticLogin)
 qlonglong UserAccount::loginFrequency() const
 {
     Q_D(const UserAccount);
-    return d->user->loginFrequency();
+    return d->loginFrequency;
 }
 
 /*!
@@ -275,7 +403,7 @@ qlonglong UserAccount::loginFrequency() const
 qlonglong UserAccount::loginTime() const
 {
     Q_D(const UserAccount);
-    return d->user->loginTime();
+    return d->loginTime;
 }
 
 /*!
@@ -284,7 +412,7 @@ qlonglong UserAccount::loginTime() const
 UserAccount::PasswordMode UserAccount::passwordMode() const
 {
     Q_D(const UserAccount);
-    return static_cast<UserAccount::PasswordMode>(d->user->passwordMode());
+    return d->passwordMode;
 }
 
 /*!
@@ -310,7 +438,7 @@ void UserAccount::setPasswordMode(UserAccount::PasswordMode mode)
 QString UserAccount::passwordHint() const
 {
     Q_D(const UserAccount);
-    return d->user->passwordHint();
+    return d->passwordHint;
 }
 
 /*!
@@ -319,7 +447,7 @@ QString UserAccount::passwordHint() const
 bool UserAccount::isLocalAccount() const
 {
     Q_D(const UserAccount);
-    return d->user->localAccount();
+    return d->localAccount;
 }
 
 /*!
@@ -328,7 +456,7 @@ bool UserAccount::isLocalAccount() const
 bool UserAccount::isSystemAccount() const
 {
     Q_D(const UserAccount);
-    return d->user->systemAccount();
+    return d->systemAccount;
 }
 
 /*!
@@ -337,7 +465,7 @@ bool UserAccount::isSystemAccount() const
 QString UserAccount::userName() const
 {
     Q_D(const UserAccount);
-    return d->user->userName();
+    return d->userName;
 }
 
 /*!
@@ -364,7 +492,7 @@ void UserAccount::setUserName(const QString &userName)
 QString UserAccount::realName() const
 {
     Q_D(const UserAccount);
-    return d->user->realName();
+    return d->realName;
 }
 
 /*!
@@ -401,7 +529,7 @@ QString UserAccount::displayName() const
 QString UserAccount::homeDirectory() const
 {
     Q_D(const UserAccount);
-    return d->user->homeDirectory();
+    return d->homeDirectory;
 }
 
 /*!
@@ -416,6 +544,7 @@ void UserAccount::setHomeDirectory(const QString &homeDirectory)
     if (this->homeDirectory() == homeDirectory)
         return;
 
+    d->homeDirectory = homeDirectory;
     d->user->SetHomeDirectory(homeDirectory);
     Q_EMIT homeDirectoryChanged();
 }
@@ -426,7 +555,7 @@ void UserAccount::setHomeDirectory(const QString &homeDirectory)
 QString UserAccount::shell() const
 {
     Q_D(const UserAccount);
-    return d->user->shell();
+    return d->shell;
 }
 
 /*!
@@ -452,7 +581,7 @@ void UserAccount::setShell(const QString &shell)
 QString UserAccount::iconFileName() const
 {
     Q_D(const UserAccount);
-    return QFile::exists(d->user->iconFile()) ? d->user->iconFile() : QString();
+    return d->iconFileExists ? d->iconFileName : QString();
 }
 
 /*!
@@ -468,6 +597,7 @@ void UserAccount::setIconFileName(const QString &fileName)
         return;
 
     d->iconFileName = fileName;
+    d->iconFileExists = QFile::exists(fileName);
     d->user->SetIconFile(fileName);
     Q_EMIT iconFileNameChanged();
 }
@@ -478,7 +608,7 @@ void UserAccount::setIconFileName(const QString &fileName)
 QString UserAccount::email() const
 {
     Q_D(const UserAccount);
-    return d->user->email();
+    return d->email;
 }
 
 /*!
@@ -504,7 +634,7 @@ void UserAccount::setEmail(const QString &email)
 QString UserAccount::language() const
 {
     Q_D(const UserAccount);
-    return d->user->language();
+    return d->language;
 }
 
 /*!
@@ -530,7 +660,7 @@ void UserAccount::setLanguage(const QString &language)
 QString UserAccount::location() const
 {
     Q_D(const UserAccount);
-    return d->user->location();
+    return d->location;
 }
 
 /*!
@@ -556,7 +686,7 @@ void UserAccount::setLocation(const QString &location)
 QString UserAccount::xsession() const
 {
     Q_D(const UserAccount);
-    return d->user->xSession();
+    return d->xsession;
 }
 
 /*!
@@ -596,7 +726,13 @@ void UserAccount::setPassword(const QString &password, const QString &hint)
 void UserAccount::setPasswordHint(const QString &hint)
 {
     Q_D(UserAccount);
+
+    if (passwordHint() == hint)
+        return;
+
+    d->passwordHint = hint;
     d->user->SetPasswordHint(hint);
+    Q_EMIT passwordHintChanged();
 }
 
 /*!
@@ -604,76 +740,11 @@ void UserAccount::setPasswordHint(const QString &hint)
  */
 void UserAccount::handleAccountChanged()
 {
-    // Catch changes outside of this API
+    // Catch changes outside of this API, Changed doesn't tell what changed
+    // so refresh the whole cache with a single call
 
     Q_D(UserAccount);
-
-    if (d->accountType != accountType()) {
-        d->accountType = accountType();
-        Q_EMIT accountTypeChanged();
-    }
-
-    if (d->locked != isLocked()) {
-        d->locked = isLocked();
-        Q_EMIT lockedChanged();
-    }
-
-    if (d->automaticLogin != automaticLogin()) {
-        d->automaticLogin = automaticLogin();
-        Q_EMIT automaticLoginChanged();
-    }
-
-    if (d->passwordMode != passwordMode()) {
-        d->passwordMode = passwordMode();
-        Q_EMIT passwordModeChanged();
-    }
-
-    if (d->userName != userName()) {
-        d->userName = userName();
-        Q_EMIT userNameChanged();
-        Q_EMIT displayNameChanged();
-    }
-
-    if (d->realName != realName()) {
-        d->realName = realName();
-        Q_EMIT realNameChanged();
-        Q_EMIT displayNameChanged();
-    }
-
-    if (d->homeDirectory != homeDirectory()) {
-        d->homeDirectory = homeDirectory();
-        Q_EMIT homeDirectoryChanged();
-    }
-
-    if (d->shell != shell()) {
-        d->shell = shell();
-        Q_EMIT shellChanged();
-    }
-
-    if (d->iconFileName != iconFileName()) {
-        d->iconFileName = iconFileName();
-        Q_EMIT iconFileNameChanged();
-    }
-
-    if (d->email != email()) {
-        d->email = email();
-        Q_EMIT emailChanged();
-    }
-
-    if (d->language != language()) {
-        d->language = language();
-        Q_EMIT languageChanged();
-    }
-
-    if (d->location != location()) {
-        d->location = location();
-        Q_EMIT locationChanged();
-    }
-
-    if (d->xsession != xsession()) {
-        d->xsession = xsession();
-        Q_EMIT xsessionChanged();
-    }
+    d->fetchProperties();
 }
 }
 
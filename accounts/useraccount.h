@@ -43,13 +43,13 @@ class UserAccount : public QObject
     Q_PROPERTY(bool locked READ isLocked WRITE setLocked NOTIFY lockedChanged)
     Q_PROPERTY(bool automaticLogin READ automaticLogin WRITE setAutomaticLogin NOTIFY
                    automaticLoginChanged)
-    Q_PROPERTY(qlonglong loginFrequency READ loginFrequency CONSTANT)
-    Q_PROPERTY(qlonglong loginTime READ loginTime CONSTANT)
+    Q_PROPERTY(qlonglong loginFrequency READ loginFrequency NOTIFY loginFrequencyChanged)
+    Q_PROPERTY(qlonglong loginTime READ loginTime NOTIFY loginTimeChanged)
     Q_PROPERTY(PasswordMode passwordMode READ passwordMode WRITE setPasswordMode NOTIFY
                    passwordModeChanged)
-    Q_PROPERTY(QString passwordHint READ passwordHint CONSTANT)
-    Q_PROPERTY(bool localAccount READ isLocalAccount CONSTANT)
-    Q_PROPERTY(bool systemAccount READ isSystemAccount CONSTANT)
+    Q_PROPERTY(QString passwordHint READ passwordHint NOTIFY passwordHintChanged)
+    Q_PROPERTY(bool localAccount READ isLocalAccount NOTIFY localAccountChanged)
+    Q_PROPERTY(bool systemAccount READ isSystemAccount NOTIFY systemAccountChanged)
     Q_PROPERTY(QString userName READ userName WRITE setUserName NOTIFY userNameChanged)
     Q_PROPERTY(QString realName READ realName WRITE setRealName NOTIFY realNameChanged)
     Q_PROPERTY(QString displayName READ displayName NOTIFY displayNameChanged)
@@ -139,7 +139,12 @@ Q_SIGNALS:
     void accountTypeChanged();
     void lockedChanged();
     void automaticLoginChanged();
+    void loginFrequencyChanged();
+    void loginTimeChanged();
     void passwordModeChanged();
+    void passwordHintChanged();
+    void localAccountChanged();
+    void systemAccountChanged();
     void userNameChanged();
     void realNameChanged();
     void displayNameChanged();
@@ -26,6 +26,8 @@
 #include "useraccount.h"
 #include "user_interface.h"
 
+class QDBusPendingCallWatcher;
+
 //
 //  W A R N I N G
 //  -------------
@@ -47,20 +49,32 @@ public:
     explicit UserAccountPrivate(UserAccount *q);
 
     void initialize(const QDBusConnection &connection, const QString &objectPath);
-    void emitSignals();
+    void fetchProperties();
+    void handlePropertiesReply(QDBusPendingCallWatcher *watcher);
+    void updateProperties(const QVariantMap &properties);
 
     QDBusConnection bus;
     OrgFreedesktopAccountsUserInterface *user;
+    QDBusPendingCallWatcher *propertiesWatcher;
+    bool propertiesDirty;
 
+    // Property cache, filled by GetAll
+    qlonglong uid;
     UserAccount::AccountType accountType;
     bool locked;
     bool automaticLogin;
+    qlonglong loginFrequency;
+    qlonglong loginTime;
     UserAccount::PasswordMode passwordMode;
+    QString passwordHint;
+    bool localAccount;
+    bool systemAccount;
     QString userName;
     QString realName;
     QString homeDirectory;
     QString shell;
     QString iconFileName;
+    bool iconFileExists;
     QString email;
     QString language;
     QString location;
@@ -20,13 +20,17 @@
  * $END_LICENSE$
  ***************************************************************************/
 
-#include <QtGui/QPixmap>
+#include <QtGui/QImage>
 
+#include "avatarcache.h"
+#include "avatarimageprovider.h"
 #include "usersmodel.h"
 #include "usersmodel_p.h"
 
 namespace QtAccountsService {
 
+static const QSize decorationSize(96, 96);
+
 /*
  * UsersModelPrivate
  */
@@ -46,31 +50,129 @@ void UsersModelPrivate::_q_userAdded(UserAccount *account)
 {
     Q_Q(UsersModel);
 
-    q->connect(account, &UserAccount::accountChanged, q, [account, q, this]() {
-        auto index = q->index(list.indexOf(account));
-        if (index.isValid())
-            Q_EMIT q->dataChanged(index, index);
+    if (rows.contains(account))
+        return;
+
+    // Forward each property change as the role it affects, so that only
+    // the bindings depending on it are evaluated again
+    auto forward = [account, q, this](void (UserAccount::*signal)(), const QVector<int> &roles) {
+        q->connect(account, signal, q, [account, roles, this]() { emitRowChanged(account, roles); });
+    };
+    forward(&UserAccount::accountTypeChanged, { UsersModel::AccountTypeRole });
+    forward(&UserAccount::lockedChanged, { UsersModel::LockedRole });
+    forward(&UserAccount::automaticLoginChanged, { UsersModel::AutomaticLoginRole });
+    forward(&UserAccount::loginFrequencyChanged, { UsersModel::LoginFrequencyRole });
+    forward(&UserAccount::loginTimeChanged, { UsersModel::LoginTimeRole });
+    forward(&UserAccount::passwordModeChanged, { UsersModel::PasswordModeRole });
+    forward(&UserAccount::passwordHintChanged, { UsersModel::PasswordHintRole });
+    forward(&UserAccount::localAccountChanged, { UsersModel::LocalAccount });
+    forward(&UserAccount::systemAccountChanged, { UsersModel::SystemAccount });
+    forward(&UserAccount::userNameChanged, { UsersModel::UserNameRole });
+    forward(&UserAccount::realNameChanged, { UsersModel::RealNameRole });
+    forward(&UserAccount::displayNameChanged, { Qt::DisplayRole, UsersModel::DisplayNameRole });
+    forward(&UserAccount::homeDirectoryChanged, { UsersModel::HomeDirectoryRole });
+    forward(&UserAccount::shellChanged, { UsersModel::ShellRole });
+    forward(&UserAccount::emailChanged, { UsersModel::EmailRole });
+    forward(&UserAccount::languageChanged, { UsersModel::LanguageRole });
+    forward(&UserAccount::locationChanged, { UsersModel::LocationRole });
+    forward(&UserAccount::xsessionChanged, { UsersModel::XSessionRole });
+
+    q->connect(account, &UserAccount::userIdChanged, q, [account, this]() {
+        indexUid(account);
+        emitRowChanged(account, { UsersModel::UserIdRole });
+    });
+
+    q->connect(account, &UserAccount::iconFileNameChanged, q, [account, this]() {
+        indexIconFile(account);
+        AvatarCache::instance()->invalidate(account->iconFileName());
+        emitRowChanged(account, { Qt::DecorationRole, UsersModel::IconFileNameRole,
+                                  UsersModel::IconSourceRole });
     });
 
     q->beginInsertRows(QModelIndex(), list.size(), list.size());
+    rows.insert(account, list.size());
+    // Accounts still waiting for their properties are indexed again once
+    // userIdChanged and iconFileNameChanged announce them
+    indexUid(account);
+    indexIconFile(account);
     list.append(account);
     q->endInsertRows();
 }
 
+void UsersModelPrivate::indexUid(UserAccount *account)
+{
+    const auto it = indexedUids.constFind(account);
+    if (it != indexedUids.constEnd() && uids.value(it.value()) == account)
+        uids.remove(it.value());
+
+    const qlonglong uid = account->userId();
+    if (uid < 0) {
+        indexedUids.remove(account);
+        return;
+    }
+
+    uids.insert(uid, account);
+    indexedUids.insert(account, uid);
+}
+
+void UsersModelPrivate::indexIconFile(UserAccount *account)
+{
+    const auto it = indexedIconFiles.constFind(account);
+    if (it != indexedIconFiles.constEnd())
+        iconFiles.remove(it.value(), account);
+
+    const QString fileName = account->iconFileName();
+    iconFiles.insert(fileName, account);
+    indexedIconFiles.insert(account, fileName);
+}
+
+void UsersModelPrivate::unindex(UserAccount *account)
+{
+    const auto uid = indexedUids.constFind(account);
+    if (uid != indexedUids.constEnd() && uids.value(uid.value()) == account)
+        uids.remove(uid.value());
+    indexedUids.remove(account);
+
+    iconFiles.remove(indexedIconFiles.take(account), account);
+}
+
+void UsersModelPrivate::emitRowChanged(UserAccount *account, const QVector<int> &roles)
+{
+    Q_Q(UsersModel);
+
+    const int row = rows.value(account, -1);
+    if (row < 0)
+        return;
+
+    auto index = q->index(row);
+    Q_EMIT q->dataChanged(index, index, roles);
+}
+
+void UsersModelPrivate::_q_avatarLoaded(const QString &fileName)
+{
+    const auto accounts = iconFiles.values(fileName);
+    for (UserAccount *account : accounts)
+        emitRowChanged(account, { Qt::DecorationRole });
+}
+
 void UsersModelPrivate::_q_userDeleted(qlonglong uid)
 {
     Q_Q(UsersModel);
 
-    for (int i = 0; i < list.size(); i++) {
-        UserAccount *curAccount = list.at(i);
+    UserAccount *account = uids.value(uid);
+    const int row = rows.value(account, -1);
+    if (row < 0)
+        return;
 
-        if (curAccount->userId() == uid) {
-            q->beginRemoveRows(QModelIndex(), i, i);
-            list.removeOne(curAccount);
-            q->endRemoveRows();
-            break;
-        }
-    }
+    q->disconnect(account, nullptr, q, nullptr);
+    unindex(account);
+
+    q->beginRemoveRows(QModelIndex(), row, row);
+    list.removeAt(row);
+    rows.remove(account);
+    for (int i = row; i < list.size(); i++)
+        rows[list.at(i)] = i;
+    q->endRemoveRows();
 }
 
 /*
@@ -87,6 +189,8 @@ UsersModel::UsersModel(QObject *parent)
             this, SLOT(_q_userAdded(UserAccount *)));
     connect(d->manager, SIGNAL(userDeleted(qlonglong)), // clazy:exclude=old-style-connect
             this, SLOT(_q_userDeleted(qlonglong)));
+    connect(AvatarCache::instance(), &AvatarCache::imageLoaded, this,
+            [d](const QString &fileName) { d->_q_avatarLoaded(fileName); });
 
     connect(d->manager, &AccountsManager::listCachedUsersFinished,
             this, [d](const UserAccountList &list) {
@@ -120,6 +224,7 @@ QHash<int, QByteArray> UsersModel::roleNames() const
     roles[EmailRole] = "email";
     roles[LocationRole] = "location";
     roles[XSessionRole] = "xsession";
+    roles[IconSourceRole] = "iconSource";
     return roles;
 }
 
@@ -143,8 +248,19 @@ QVariant UsersModel::data(const QModelIndex &index, int role) const
     case Qt::DisplayRole:
     case DisplayNameRole:
         return user->displayName();
-    case Qt::DecorationRole:
-        return QPixmap(user->iconFileName());
+    case Qt::DecorationRole: {
+        // Never decode on the GUI thread, the row is updated once the
+        // picture is in the cache
+        const QString fileName = user->iconFileName();
+        if (fileName.isEmpty())
+            return QVariant();
+        const QImage image = AvatarCache::instance()->image(fileName, decorationSize);
+        if (image.isNull()) {
+            AvatarCache::instance()->request(fileName, decorationSize);
+            return QVariant();
+        }
+        return image;
+    }
     case UserAccountRole:
         return QVariant::fromValue(user);
     case UserIdRole:
@@ -185,6 +301,8 @@ QVariant UsersModel::data(const QModelIndex &index, int role) const
         return user->location();
     case XSessionRole:
         return user->xsession();
+    case IconSourceRole:
+        return AvatarImageProvider::imageSource(user->iconFileName());
     default:
         break;
     }
@@ -232,6 +350,18 @@ UserAccount *UsersModel::userAccount(const QModelIndex &index) const
 
     return d->list[index.row()];
 }
+
+/*!
+    Returns the manager populating this model.
+
+    Lookups done through it return the same UserAccount objects as
+    the model rows.
+*/
+AccountsManager *UsersModel::manager() const
+{
+    Q_D(const UsersModel);
+    return d->manager;
+}
 }
 
 #include "moc_usersmodel.cpp"
@@ -27,12 +27,14 @@
 
 namespace QtAccountsService {
 
+class AccountsManager;
 class UserAccount;
 class UsersModelPrivate;
 
 class UsersModel : public QAbstractListModel
 {
     Q_OBJECT
+    Q_PROPERTY(QtAccountsService::AccountsManager *manager READ manager CONSTANT)
     Q_DECLARE_PRIVATE(UsersModel)
 public:
     enum Roles {
@@ -56,7 +58,8 @@ public:
         EmailRole,
         LanguageRole,
         LocationRole,
-        XSessionRole
+        XSessionRole,
+        IconSourceRole
     };
     Q_ENUM(Roles)
 
@@ -71,6 +74,8 @@ public:
 
     UserAccount *userAccount(const QModelIndex &index) const;
 
+    AccountsManager *manager() const;
+
 private:
     UsersModelPrivate *const d_ptr;
 
@@ -26,6 +26,9 @@
 #include "accountsmanager.h"
 #include "useraccount.h"
 
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+
 //
 //  W A R N I N G
 //  -------------
@@ -49,13 +52,24 @@ public:
     ~UsersModelPrivate();
 
     void populate();
+    void emitRowChanged(UserAccount *account, const QVector<int> &roles);
+    void indexUid(UserAccount *account);
+    void indexIconFile(UserAccount *account);
+    void unindex(UserAccount *account);
 
     AccountsManager *manager;
     UserAccountList list;
+    QHash<UserAccount *, int> rows;
+    QHash<qlonglong, UserAccount *> uids;
+    QMultiHash<QString, UserAccount *> iconFiles;
+    // What each account is indexed under in uids and iconFiles
+    QHash<UserAccount *, qlonglong> indexedUids;
+    QHash<UserAccount *, QString> indexedIconFiles;
 
 public Q_SLOTS:
     void _q_userAdded(UserAccount *account);
     void _q_userDeleted(qlonglong uid);
+    void _q_avatarLoaded(const QString &fileName);
 
 protected:
     UsersModel *q_ptr;
@@ -1,4 +1,5 @@
 /* config.h.  Generated by cmake from config.h.cmake  */
 
 #cmakedefine01 USE_GSETTINGS
-#cmakedefine01 USE_GCONF
\ No newline at end of file
+#cmakedefine01 USE_GCONF
+#cmakedefine01 HAVE_SNDFILE
@@ -349,8 +349,8 @@ void Context::subscribeCallback(pa_context *context, pa_subscription_event_type_
         if ((type & PA_SUBSCRIPTION_EVENT_TYPE_MASK) == PA_SUBSCRIPTION_EVENT_REMOVE) {
             m_modules.removeEntry(index);
         } else {
-            if (!PAOperation(pa_context_get_module_info_list(context, module_info_list_cb, this))) {
-                qCWarning(PLASMAPA) << "pa_context_get_module_info_list() failed";
+            if (!PAOperation(pa_context_get_module_info(context, index, module_info_list_cb, this))) {
+                qCWarning(PLASMAPA) << "pa_context_get_module_info() failed";
                 return;
             }
         }
@@ -6,6 +6,7 @@
  */
 
 #include <QString>
+#include <QTimer>
 
 #include "debug.h"
 #include "gsettingsitem.h"
@@ -16,24 +17,13 @@ QVariant GSettingsItem::value(const QString &key) const
         return QVariant();
     }
 
-    GVariant *gvalue = g_settings_get_value(m_settings, key.toLatin1().data());
-
-    QVariant toReturn;
-
-    switch (g_variant_classify(gvalue)) {
-    case G_VARIANT_CLASS_BOOLEAN:
-        toReturn = QVariant((bool)g_variant_get_boolean(gvalue));
-        break;
-    case G_VARIANT_CLASS_STRING:
-        toReturn = QVariant(QString::fromUtf8(g_variant_get_string(gvalue, nullptr)));
-        break;
-    default:
-        qCWarning(PLASMAPA()) << "Unhandled variant type in value()";
+    Key &entry = this->key(key);
+    if (!entry.cached) {
+        entry.value = read(entry);
+        entry.cached = true;
     }
 
-    g_variant_unref(gvalue);
-
-    return toReturn;
+    return entry.value;
 }
 
 void GSettingsItem::set(const QString &key, const QVariant &val)
@@ -42,30 +32,43 @@ void GSettingsItem::set(const QString &key, const QVariant &val)
         return;
     }
 
-    // It might be hard to detect the right GVariant type from
-    // complex QVariant types such as string lists or more detailed
-    // types such as integers (GVariant has different sizes),
-    // therefore we get the current value for the key and convert
-    // to QVariant using the GVariant type
-    GVariant *oldValue = g_settings_get_value(m_settings, key.toLatin1().data());
+    // The GVariant type can't be guessed reliably from a QVariant (string
+    // lists, integer sizes...), it comes from the schema instead
+    Key &entry = this->key(key);
     GVariant *newValue = nullptr;
+    QVariant cachedValue;
 
-    switch (g_variant_type_peek_string(g_variant_get_type(oldValue))[0]) {
+    switch (entry.type) {
     case G_VARIANT_CLASS_BOOLEAN:
         newValue = g_variant_new_boolean(val.toBool());
+        cachedValue = QVariant(val.toBool());
         break;
     case G_VARIANT_CLASS_STRING:
         newValue = g_variant_new_string(val.toString().toUtf8().constData());
+        cachedValue = QVariant(val.toString());
         break;
     default:
         qCWarning(PLASMAPA()) << "Unhandled variant type in set()";
     }
 
-    if (newValue) {
-        g_settings_set_value(m_settings, key.toLatin1().data(), newValue);
+    if (!newValue) {
+        return;
+    }
+
+    // Settings are in delay-apply mode, this only stages the value
+    g_settings_set_value(m_settings, entry.name.constData(), newValue);
+    if (!m_applyTimer->isActive()) {
+        m_applyTimer->start();
     }
 
-    g_variant_unref(oldValue);
+    const bool changed = !entry.cached || entry.value != cachedValue;
+    entry.value = cachedValue;
+    entry.cached = true;
+
+    if (changed) {
+        Q_EMIT valueChanged(key, cachedValue);
+        Q_EMIT subtreeChanged();
+    }
 }
 
 bool GSettingsItem::isValid() const
@@ -73,6 +76,80 @@ bool GSettingsItem::isValid() const
     return m_settings;
 }
 
+GSettingsItem::Key &GSettingsItem::key(const QString &name) const
+{
+    auto it = m_keys.find(name);
+    if (it != m_keys.end()) {
+        return it.value();
+    }
+
+    Key entry;
+    entry.name = name.toLatin1();
+
+    // g_settings_get_value() aborts on keys the schema doesn't have
+    if (m_schema && g_settings_schema_has_key(m_schema, entry.name.constData())) {
+        GSettingsSchemaKey *schemaKey = g_settings_schema_get_key(m_schema, entry.name.constData());
+        entry.type = g_variant_type_peek_string(g_settings_schema_key_get_value_type(schemaKey))[0];
+        g_settings_schema_key_unref(schemaKey);
+    } else {
+        qCWarning(PLASMAPA) << "Settings schema has no key" << name;
+    }
+
+    return m_keys.insert(name, entry).value();
+}
+
+QVariant GSettingsItem::read(const Key &key) const
+{
+    if (!key.type) {
+        return QVariant();
+    }
+
+    GVariant *gvalue = g_settings_get_value(m_settings, key.name.constData());
+
+    QVariant toReturn;
+
+    switch (g_variant_classify(gvalue)) {
+    case G_VARIANT_CLASS_BOOLEAN:
+        toReturn = QVariant((bool)g_variant_get_boolean(gvalue));
+        break;
+    case G_VARIANT_CLASS_STRING:
+        toReturn = QVariant(QString::fromUtf8(g_variant_get_string(gvalue, nullptr)));
+        break;
+    default:
+        qCWarning(PLASMAPA()) << "Unhandled variant type in value()";
+    }
+
+    g_variant_unref(gvalue);
+
+    return toReturn;
+}
+
+void GSettingsItem::applyPending()
+{
+    m_applyTimer->stop();
+
+    // One dconf change set for everything staged since the last apply, so
+    // e.g. ConfigModule's locked/name/args/enabled sequence lands at once
+    g_settings_apply(m_settings);
+    m_written = true;
+}
+
+void GSettingsItem::keyChanged(const char *name)
+{
+    const QString keyName = QString::fromLatin1(name);
+    Key &entry = key(keyName);
+
+    const QVariant newValue = read(entry);
+    const bool changed = !entry.cached || entry.value != newValue;
+    entry.value = newValue;
+    entry.cached = true;
+
+    if (changed) {
+        Q_EMIT valueChanged(keyName, newValue);
+        Q_EMIT subtreeChanged();
+    }
+}
+
 GSettingsItem::GSettingsItem(const QString &key, QObject *parent)
     : QObject(parent)
 {
@@ -85,22 +162,41 @@ GSettingsItem::GSettingsItem(const QString &key, QObject *parent)
         return;
     }
 
-    auto *schema = g_settings_schema_source_lookup(defaultSource, schemaId, true /*recursive*/);
-    if (!schema) {
+    m_schema = g_settings_schema_source_lookup(defaultSource, schemaId, true /*recursive*/);
+    if (!m_schema) {
         qCWarning(PLASMAPA) << "Settings schema" << schemaId << "is not installed";
         return;
     }
 
     m_settings = g_settings_new_with_path(schemaId, key.toLatin1().data());
-    g_settings_schema_unref(schema);
+    g_settings_delay(m_settings);
+
+    m_applyTimer = new QTimer(this);
+    m_applyTimer->setSingleShot(true);
+    m_applyTimer->setInterval(0);
+    connect(m_applyTimer, &QTimer::timeout, this, &GSettingsItem::applyPending);
 
     g_signal_connect(m_settings, "changed", G_CALLBACK(GSettingsItem::settingChanged), this);
 }
 
 GSettingsItem::~GSettingsItem()
 {
-    g_settings_sync();
     if (m_settings) {
+        g_signal_handlers_disconnect_by_data(m_settings, this);
+
+        if (m_applyTimer->isActive()) {
+            applyPending();
+        }
+
+        // Only wait for dconf if this item actually wrote something
+        if (m_written) {
+            g_settings_sync();
+        }
+
         g_object_unref(m_settings);
     }
+
+    if (m_schema) {
+        g_settings_schema_unref(m_schema);
+    }
 }
@@ -8,12 +8,19 @@
 #ifndef GSETTINGSITEM_H
 #define GSETTINGSITEM_H
 
+#include <QHash>
 #include <QObject>
 #include <QStringList>
 #include <QVariant>
 
 #include <gio/gio.h>
 
+class QTimer;
+
+// Reads are answered from a per-key cache that the "changed" signal keeps
+// current, so property bindings never go to dconf. Key types are resolved
+// from the schema once. Writes update the cache immediately and are applied
+// to dconf together from the event loop.
 class GSettingsItem : public QObject
 {
     Q_OBJECT
@@ -29,17 +36,34 @@ public:
 
 Q_SIGNALS:
     void subtreeChanged();
+    void valueChanged(const QString &key, const QVariant &value);
 
 private:
+    struct Key {
+        QByteArray name;
+        // First character of the GVariant type string, 0 if the schema lacks the key
+        char type = 0;
+        QVariant value;
+        bool cached = false;
+    };
+
+    Key &key(const QString &name) const;
+    QVariant read(const Key &key) const;
+    void applyPending();
+    void keyChanged(const char *name);
+
     GSettings *m_settings = nullptr;
+    GSettingsSchema *m_schema = nullptr;
+    QTimer *m_applyTimer = nullptr;
+    mutable QHash<QString, Key> m_keys;
+    bool m_written = false;
 
     static void settingChanged(GSettings *settings, const gchar *key, gpointer data)
     {
         Q_UNUSED(settings)
-        Q_UNUSED(key)
 
         GSettingsItem *self = static_cast<GSettingsItem *>(data);
-        Q_EMIT self->subtreeChanged();
+        self->keyChanged(key);
     }
 };
 
@@ -20,8 +20,6 @@
 #define PA_SETTINGS_PATH_MODULES "/system/pulseaudio/modules"
 #endif
 
-#include <QTimer>
-
 namespace QPulseAudio
 {
 #if USE_GCONF || USE_GSETTINGS
@@ -83,20 +81,33 @@ ModuleManager::ModuleManager(QObject *parent)
     m_switchOnConnect = new ConfigModule(QStringLiteral("switch-on-connect"), QStringLiteral("module-switch-on-connect"), this);
     m_deviceManager = new ConfigModule(QStringLiteral("device-manager"), QStringLiteral("module-device-manager"), this);
 
+#if USE_GSETTINGS
+    // Only "enabled" is exposed, locked/name0/args0 don't need to re-evaluate bindings
+    const auto onEnabledChanged = [this](void (ModuleManager::*signal)()) {
+        return [this, signal](const QString &key) {
+            if (key == QLatin1String("enabled")) {
+                Q_EMIT(this->*signal)();
+            }
+        };
+    };
+    connect(m_combineSinks, &ConfigModule::valueChanged, this, onEnabledChanged(&ModuleManager::combineSinksChanged));
+    connect(m_switchOnConnect, &ConfigModule::valueChanged, this, onEnabledChanged(&ModuleManager::switchOnConnectChanged));
+    connect(m_deviceManager, &ConfigModule::valueChanged, this, onEnabledChanged(&ModuleManager::switchOnConnectChanged));
+#else
     connect(m_combineSinks, &ConfigModule::subtreeChanged, this, &ModuleManager::combineSinksChanged);
     connect(m_switchOnConnect, &ConfigModule::subtreeChanged, this, &ModuleManager::switchOnConnectChanged);
     connect(m_deviceManager, &ConfigModule::subtreeChanged, this, &ModuleManager::switchOnConnectChanged);
+#endif
 #endif
 
     connect(Context::instance()->server(), &Server::updated, this, &ModuleManager::serverUpdated);
 
-    QTimer *updateModulesTimer = new QTimer(this);
-    updateModulesTimer->setInterval(500);
-    updateModulesTimer->setSingleShot(true);
-    connect(updateModulesTimer, &QTimer::timeout, this, &ModuleManager::updateLoadedModules);
-    connect(&Context::instance()->modules(), &MapBaseQObject::added, updateModulesTimer, static_cast<void (QTimer::*)(void)>(&QTimer::start));
-    connect(&Context::instance()->modules(), &MapBaseQObject::removed, updateModulesTimer, static_cast<void (QTimer::*)(void)>(&QTimer::start));
-    updateLoadedModules();
+    const auto &modules = Context::instance()->modules();
+    connect(&modules, &MapBaseQObject::added, this, &ModuleManager::moduleAdded);
+    connect(&modules, &MapBaseQObject::aboutToBeRemoved, this, &ModuleManager::moduleAboutToBeRemoved);
+    for (int i = 0; i < modules.count(); ++i) {
+        moduleAdded(i);
+    }
 }
 
 ModuleManager::~ModuleManager(){};
@@ -161,22 +172,62 @@ void ModuleManager::setSwitchOnConnect(bool switchOnConnect)
 
 QStringList ModuleManager::loadedModules() const
 {
+    if (m_loadedModulesDirty) {
+        m_loadedModules = m_moduleRefs.keys();
+        m_loadedModules.sort();
+        m_loadedModulesDirty = false;
+    }
     return m_loadedModules;
 }
 
-void ModuleManager::updateLoadedModules()
+void ModuleManager::moduleAdded(int index)
+{
+    auto *module = static_cast<Module *>(Context::instance()->modules().objectAt(index));
+    const quint32 paIndex = module->index();
+
+    m_moduleNames.insert(paIndex, module->name());
+    addModuleRef(module->name());
+
+    connect(module, &Module::nameChanged, this, [this, module, paIndex]() {
+        removeModuleRef(m_moduleNames.value(paIndex));
+        m_moduleNames.insert(paIndex, module->name());
+        addModuleRef(module->name());
+    });
+}
+
+void ModuleManager::moduleAboutToBeRemoved(int index)
 {
-    m_loadedModules.clear();
-    const auto modules = Context::instance()->modules().data();
-    for (Module *module : modules) {
-        m_loadedModules.append(module->name());
+    auto *module = static_cast<Module *>(Context::instance()->modules().objectAt(index));
+
+    removeModuleRef(m_moduleNames.take(module->index()));
+}
+
+void ModuleManager::addModuleRef(const QString &name)
+{
+    // Only the first instance of a module changes what's loaded
+    if (m_moduleRefs[name]++ == 0) {
+        m_loadedModulesDirty = true;
+        Q_EMIT loadedModulesChanged();
+    }
+}
+
+void ModuleManager::removeModuleRef(const QString &name)
+{
+    auto it = m_moduleRefs.find(name);
+    if (it == m_moduleRefs.end()) {
+        return;
+    }
+
+    if (--it.value() == 0) {
+        m_moduleRefs.erase(it);
+        m_loadedModulesDirty = true;
+        Q_EMIT loadedModulesChanged();
     }
-    Q_EMIT loadedModulesChanged();
 }
 
 bool ModuleManager::configModuleLoaded() const
 {
-    return m_loadedModules.contains(configModuleName());
+    return m_moduleRefs.contains(configModuleName());
 }
 
 QString ModuleManager::configModuleName() const
@@ -7,6 +7,7 @@
 #ifndef MODULEMANAGER_H
 #define MODULEMANAGER_H
 
+#include <QHash>
 #include <QString>
 
 #include <pulse/introspect.h>
@@ -48,12 +49,21 @@ Q_SIGNALS:
     void serverUpdated();
 
 private:
-    void updateLoadedModules();
+    void moduleAdded(int index);
+    void moduleAboutToBeRemoved(int index);
+    void addModuleRef(const QString &name);
+    void removeModuleRef(const QString &name);
 
     ConfigModule *m_combineSinks;
     ConfigModule *m_switchOnConnect;
     ConfigModule *m_deviceManager;
-    QStringList m_loadedModules;
+
+    // Loaded module name -> number of instances, updated from module add/remove
+    QHash<QString, int> m_moduleRefs;
+    // PulseAudio module index -> name it was counted under
+    QHash<quint32, QString> m_moduleNames;
+    mutable QStringList m_loadedModules;
+    mutable bool m_loadedModulesDirty = true;
 };
 
 } // QPulseAudio
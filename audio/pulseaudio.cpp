@@ -6,6 +6,7 @@
 */
 
 #include "pulseaudio.h"
+#include "pulseaudio_p.h"
 
 #include "card.h"
 #include "debug.h"
@@ -31,7 +32,7 @@ AbstractModel::AbstractModel(const MapBaseQObject *map, QObject *parent)
         beginInsertRows(QModelIndex(), index, index);
     });
     connect(m_map, &MapBaseQObject::added, this, [this](int index) {
-        onDataAdded(index);
+        Q_UNUSED(index);
         endInsertRows();
         Q_EMIT countChanged();
     });
@@ -47,6 +48,10 @@ AbstractModel::AbstractModel(const MapBaseQObject *map, QObject *parent)
 
 AbstractModel::~AbstractModel()
 {
+    // The last model of a type takes the shared connections down with it,
+    // that has to happen while the context and its maps are still around
+    m_backend.reset();
+
     // deref context after we've deleted this object
     // see https://bugs.kde.org/show_bug.cgi?id=371215
     Context::instance()->unref();
@@ -54,9 +59,8 @@ AbstractModel::~AbstractModel()
 
 QHash<int, QByteArray> AbstractModel::roleNames() const
 {
-    if (!m_roles.empty()) {
-        qCDebug(PLASMAPA) << "returning roles" << m_roles;
-        return m_roles;
+    if (m_backend) {
+        return m_backend->roleNames();
     }
     Q_UNREACHABLE();
     return QHash<int, QByteArray>();
@@ -82,7 +86,7 @@ QVariant AbstractModel::data(const QModelIndex &index, int role) const
     } else if (role == Qt::DisplayRole) {
         return static_cast<PulseObject *>(data)->properties().value(QStringLiteral("name")).toString();
     }
-    int property = m_objectProperties.value(role, -1);
+    int property = m_backend->propertyIndex(role);
     if (property == -1) {
         return QVariant();
     }
@@ -94,7 +98,7 @@ bool AbstractModel::setData(const QModelIndex &index, const QVariant &value, int
     if (!hasIndex(index.row(), index.column())) {
         return false;
     }
-    int propertyIndex = m_objectProperties.value(role, -1);
+    int propertyIndex = m_backend->propertyIndex(role);
     if (propertyIndex == -1) {
         return false;
     }
@@ -105,8 +109,7 @@ bool AbstractModel::setData(const QModelIndex &index, const QVariant &value, int
 
 int AbstractModel::role(const QByteArray &roleName) const
 {
-    qCDebug(PLASMAPA) << roleName << m_roles.key(roleName, -1);
-    return m_roles.key(roleName, -1);
+    return m_backend ? m_backend->role(roleName) : -1;
 }
 
 Context *AbstractModel::context() const
@@ -116,12 +119,35 @@ Context *AbstractModel::context() const
 
 void AbstractModel::initRoleNames(const QMetaObject &qobjectMetaObject)
 {
-    m_roles[PulseObjectRole] = QByteArrayLiteral("PulseObject");
+    m_backend = ModelBackend::acquire(*metaObject(), qobjectMetaObject, m_map);
+
+    connect(m_backend.data(), &ModelBackend::propertyChanged, this, [this](int row, int role) {
+        Q_EMIT dataChanged(createIndex(row, 0), createIndex(row, 0), {role});
+    });
+}
+
+QSharedPointer<ModelBackend> ModelBackend::acquire(const QMetaObject &modelMetaObject, const QMetaObject &objectMetaObject, const MapBaseQObject *map)
+{
+    static QHash<const QMetaObject *, QWeakPointer<ModelBackend>> s_backends;
+
+    QSharedPointer<ModelBackend> backend = s_backends.value(&modelMetaObject).toStrongRef();
+    if (!backend || backend->m_map != map) {
+        backend.reset(new ModelBackend(modelMetaObject, objectMetaObject, map));
+        s_backends.insert(&modelMetaObject, backend);
+    }
+
+    return backend;
+}
+
+ModelBackend::ModelBackend(const QMetaObject &modelMetaObject, const QMetaObject &objectMetaObject, const MapBaseQObject *map)
+    : m_map(map)
+{
+    m_roles[AbstractModel::PulseObjectRole] = QByteArrayLiteral("PulseObject");
 
     QMetaEnum enumerator;
-    for (int i = 0; i < metaObject()->enumeratorCount(); ++i) {
-        if (metaObject()->enumerator(i).name() == QLatin1String("ItemRole")) {
-            enumerator = metaObject()->enumerator(i);
+    for (int i = 0; i < modelMetaObject.enumeratorCount(); ++i) {
+        if (modelMetaObject.enumerator(i).name() == QLatin1String("ItemRole")) {
+            enumerator = modelMetaObject.enumerator(i);
             break;
         }
     }
@@ -143,9 +169,8 @@ void AbstractModel::initRoleNames(const QMetaObject &qobjectMetaObject)
         }
     }
     Q_ASSERT(maxEnumValue != -1);
-    auto mo = qobjectMetaObject;
-    for (int i = 0; i < mo.propertyCount(); ++i) {
-        QMetaProperty property = mo.property(i);
+    for (int i = 0; i < objectMetaObject.propertyCount(); ++i) {
+        QMetaProperty property = objectMetaObject.property(i);
         QString name(property.name());
         name.replace(0, 1, name.at(0).toUpper());
         m_roles[++maxEnumValue] = name.toLatin1();
@@ -153,54 +178,50 @@ void AbstractModel::initRoleNames(const QMetaObject &qobjectMetaObject)
         if (!property.hasNotifySignal()) {
             continue;
         }
-        m_signalIndexToProperties.insert(property.notifySignalIndex(), i);
+        m_signalRoles.insert(property.notifySignalIndex(), maxEnumValue);
     }
     qCDebug(PLASMAPA) << m_roles;
 
-    // Connect to property changes also with objects already in model
+    for (auto it = m_roles.constBegin(); it != m_roles.constEnd(); ++it) {
+        m_roleForName.insert(it.value(), it.key());
+    }
+
+    connect(m_map, &MapBaseQObject::added, this, &ModelBackend::connectObject);
+
+    // Connect to property changes also with objects already in the map
     for (int i = 0; i < m_map->count(); ++i) {
-        onDataAdded(i);
+        connectObject(i);
     }
 }
 
-void AbstractModel::propertyChanged()
+ModelBackend::~ModelBackend()
+{
+}
+
+void ModelBackend::onPropertyChanged()
 {
     if (!sender() || senderSignalIndex() == -1) {
         return;
     }
-    int propertyIndex = m_signalIndexToProperties.value(senderSignalIndex(), -1);
-    if (propertyIndex == -1) {
-        return;
-    }
-    int role = m_objectProperties.key(propertyIndex, -1);
+    int role = m_signalRoles.value(senderSignalIndex(), -1);
     if (role == -1) {
         return;
     }
     int index = m_map->indexOfObject(sender());
-    qCDebug(PLASMAPA) << "PROPERTY CHANGED (" << index << ") :: " << role << roleNames().value(role);
-    Q_EMIT dataChanged(createIndex(index, 0), createIndex(index, 0), {role});
+    qCDebug(PLASMAPA) << "PROPERTY CHANGED (" << index << ") :: " << role << m_roles.value(role);
+    Q_EMIT propertyChanged(index, role);
 }
 
-void AbstractModel::onDataAdded(int index)
+void ModelBackend::connectObject(int index)
 {
+    static const QMetaMethod s_slot = staticMetaObject.method(staticMetaObject.indexOfSlot("onPropertyChanged()"));
+
     QObject *data = m_map->objectAt(index);
     const QMetaObject *mo = data->metaObject();
     // We have all the data changed notify signals already stored
-    auto keys = m_signalIndexToProperties.keys();
-    Q_FOREACH (int index, keys) {
-        QMetaMethod meth = mo->method(index);
-        connect(data, meth, this, propertyChangedMetaMethod());
-    }
-}
-
-QMetaMethod AbstractModel::propertyChangedMetaMethod() const
-{
-    auto mo = metaObject();
-    int methodIndex = mo->indexOfMethod("propertyChanged()");
-    if (methodIndex == -1) {
-        return QMetaMethod();
+    for (auto it = m_signalRoles.constBegin(); it != m_signalRoles.constEnd(); ++it) {
+        connect(data, mo->method(it.key()), this, s_slot);
     }
-    return mo->method(methodIndex);
 }
 
 SinkModel::SinkModel(QObject *parent)
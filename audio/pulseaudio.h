@@ -9,12 +9,14 @@
 #define PULSEAUDIO_H
 
 #include <QAbstractListModel>
+#include <QSharedPointer>
 
 #include "maps.h"
 
 namespace QPulseAudio
 {
 class Context;
+class ModelBackend;
 
 class AbstractModel : public QAbstractListModel
 {
@@ -43,18 +45,10 @@ protected:
     void initRoleNames(const QMetaObject &qobjectMetaObject);
     Context *context() const;
 
-private Q_SLOTS:
-    void propertyChanged();
-
 private:
-    void onDataAdded(int index);
-    void onDataRemoved(int index);
-    QMetaMethod propertyChangedMetaMethod() const;
-
     const MapBaseQObject *m_map;
-    QHash<int, QByteArray> m_roles;
-    QHash<int, int> m_objectProperties;
-    QHash<int, int> m_signalIndexToProperties;
+    // Role table and object connections, shared with all models of this type
+    QSharedPointer<ModelBackend> m_backend;
 
 private:
     // Prevent leaf-classes from default constructing as we want to enforce
@@ -0,0 +1,70 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#ifndef PULSEAUDIO_P_H
+#define PULSEAUDIO_P_H
+
+#include <QHash>
+#include <QObject>
+#include <QSharedPointer>
+
+#include "maps.h"
+
+namespace QPulseAudio
+{
+/**
+ * State shared by every instance of one AbstractModel subclass.
+ *
+ * Holds the role table derived from the model's ItemRole enum and the object
+ * properties, and the NOTIFY connections of the objects in the map. Model
+ * instances are thin facades that only translate propertyChanged() into
+ * dataChanged(), so the per-object connection count no longer grows with the
+ * number of models (applet, settings page, microphone indicator...).
+ */
+class ModelBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    static QSharedPointer<ModelBackend> acquire(const QMetaObject &modelMetaObject, const QMetaObject &objectMetaObject, const MapBaseQObject *map);
+
+    ~ModelBackend() override;
+
+    const QHash<int, QByteArray> &roleNames() const
+    {
+        return m_roles;
+    }
+
+    int role(const QByteArray &roleName) const
+    {
+        return m_roleForName.value(roleName, -1);
+    }
+
+    int propertyIndex(int role) const
+    {
+        return m_objectProperties.value(role, -1);
+    }
+
+Q_SIGNALS:
+    void propertyChanged(int row, int role);
+
+private Q_SLOTS:
+    void onPropertyChanged();
+
+private:
+    ModelBackend(const QMetaObject &modelMetaObject, const QMetaObject &objectMetaObject, const MapBaseQObject *map);
+
+    void connectObject(int index);
+
+    const MapBaseQObject *m_map;
+    QHash<int, QByteArray> m_roles;
+    QHash<QByteArray, int> m_roleForName;
+    QHash<int, int> m_objectProperties;
+    // NOTIFY signal index -> role
+    QHash<int, int> m_signalRoles;
+};
+
+} // QPulseAudio
+
+#endif // PULSEAUDIO_P_H
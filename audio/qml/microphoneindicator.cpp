@@ -17,8 +17,9 @@
 
 #include "client.h"
 #include "context.h"
-#include "pulseaudio.h"
+#include "server.h"
 #include "source.h"
+#include "sourceoutput.h"
 
 #include "volumeosd.h"
 
@@ -26,26 +27,40 @@ using namespace QPulseAudio;
 
 MicrophoneIndicator::MicrophoneIndicator(QObject *parent)
     : QObject(parent)
-    , m_sourceModel(new SourceModel(this))
-    , m_sourceOutputModel(new SourceOutputModel(this))
     , m_updateTimer(new QTimer(this))
 {
-    connect(m_sourceModel, &QAbstractItemModel::rowsInserted, this, &MicrophoneIndicator::scheduleUpdate);
-    connect(m_sourceModel, &QAbstractItemModel::rowsRemoved, this, &MicrophoneIndicator::scheduleUpdate);
-    connect(m_sourceModel, &QAbstractItemModel::dataChanged, this, &MicrophoneIndicator::scheduleUpdate);
-
-    connect(m_sourceOutputModel, &QAbstractItemModel::rowsInserted, this, &MicrophoneIndicator::scheduleUpdate);
-    connect(m_sourceOutputModel, &QAbstractItemModel::rowsRemoved, this, &MicrophoneIndicator::scheduleUpdate);
-    connect(m_sourceOutputModel, &QAbstractItemModel::dataChanged, this, &MicrophoneIndicator::scheduleUpdate);
-
     m_updateTimer->setInterval(0);
     m_updateTimer->setSingleShot(true);
     connect(m_updateTimer, &QTimer::timeout, this, &MicrophoneIndicator::update);
 
+    Context *context = Context::instance();
+    context->ref();
+
+    // Works on the context's maps directly, which every model in the process
+    // shares, and only listens to the properties shown in the tray
+    const SourceMap &sources = context->sources();
+    connect(&sources, &MapBaseQObject::added, this, &MicrophoneIndicator::sourceAdded);
+    connect(&sources, &MapBaseQObject::removed, this, &MicrophoneIndicator::scheduleUpdate);
+    for (int i = 0; i < sources.count(); ++i) {
+        sourceAdded(i);
+    }
+
+    const SourceOutputMap &sourceOutputs = context->sourceOutputs();
+    connect(&sourceOutputs, &MapBaseQObject::added, this, &MicrophoneIndicator::sourceOutputAdded);
+    connect(&sourceOutputs, &MapBaseQObject::aboutToBeRemoved, this, &MicrophoneIndicator::sourceOutputAboutToBeRemoved);
+    for (int i = 0; i < sourceOutputs.count(); ++i) {
+        sourceOutputAdded(i);
+    }
+
+    connect(context->server(), &Server::defaultSourceChanged, this, &MicrophoneIndicator::scheduleUpdate);
+
     scheduleUpdate();
 }
 
-MicrophoneIndicator::~MicrophoneIndicator() = default;
+MicrophoneIndicator::~MicrophoneIndicator()
+{
+    Context::instance()->unref();
+}
 
 void MicrophoneIndicator::init()
 {
@@ -59,13 +74,74 @@ void MicrophoneIndicator::scheduleUpdate()
     }
 }
 
+void MicrophoneIndicator::sourceAdded(int index)
+{
+    auto *source = static_cast<Source *>(Context::instance()->sources().objectAt(index));
+
+    connect(source, &Source::mutedChanged, this, &MicrophoneIndicator::scheduleUpdate);
+    connect(source, &Source::volumeChanged, this, &MicrophoneIndicator::scheduleUpdate);
+    connect(source, &Source::descriptionChanged, this, &MicrophoneIndicator::scheduleUpdate);
+
+    scheduleUpdate();
+}
+
+void MicrophoneIndicator::sourceOutputAdded(int index)
+{
+    auto *sourceOutput = static_cast<SourceOutput *>(Context::instance()->sourceOutputs().objectAt(index));
+
+    connect(sourceOutput, &SourceOutput::virtualStreamChanged, this, [this, sourceOutput]() {
+        updateRecording(sourceOutput);
+    });
+
+    // Only affect the tooltip, and only while the stream is listed there
+    const auto updateIfRecording = [this, sourceOutput]() {
+        if (m_recording.contains(sourceOutput->index())) {
+            scheduleUpdate();
+        }
+    };
+    connect(sourceOutput, &SourceOutput::nameChanged, this, updateIfRecording);
+    connect(sourceOutput, &SourceOutput::clientChanged, this, updateIfRecording);
+    connect(sourceOutput, &SourceOutput::deviceIndexChanged, this, updateIfRecording);
+
+    updateRecording(sourceOutput);
+}
+
+void MicrophoneIndicator::sourceOutputAboutToBeRemoved(int index)
+{
+    auto *sourceOutput = static_cast<SourceOutput *>(Context::instance()->sourceOutputs().objectAt(index));
+
+    if (m_recording.remove(sourceOutput->index())) {
+        scheduleUpdate();
+    }
+}
+
+void MicrophoneIndicator::updateRecording(SourceOutput *sourceOutput)
+{
+    const bool recording = !sourceOutput->isVirtualStream();
+
+    if (recording == m_recording.contains(sourceOutput->index())) {
+        return;
+    }
+
+    if (recording) {
+        m_recording.insert(sourceOutput->index(), sourceOutput);
+    } else {
+        m_recording.remove(sourceOutput->index());
+    }
+
+    scheduleUpdate();
+}
+
 void MicrophoneIndicator::update()
 {
-    const auto apps = recordingApplications();
-    if (apps.isEmpty()) {
+    // If there are no microphones present, there's nothing to record
+    if (m_recording.isEmpty() || Context::instance()->sources().count() == 0) {
         m_showOsdOnUpdate = false;
         delete m_sni;
         m_sni = nullptr;
+        m_iconName.clear();
+        m_toolTipTitle.clear();
+        m_toolTipSubTitle.clear();
         return;
     }
 
@@ -104,6 +180,8 @@ void MicrophoneIndicator::update()
 
         // don't let it quit plasmashell
         m_sni->setStandardActionsEnabled(false);
+
+        m_sni->setTitle(i18n("Microphone"));
     }
 
     const bool allMuted = muted();
@@ -112,7 +190,7 @@ void MicrophoneIndicator::update()
     if (allMuted) {
         iconName = QStringLiteral("microphone-sensitivity-muted");
     } else {
-        if (Source *defaultSource = m_sourceModel->defaultSource()) {
+        if (Source *defaultSource = Context::instance()->server()->defaultSource()) {
             const int percent = volumePercent(defaultSource);
             iconName = QStringLiteral("microphone-sensitivity");
             // it deliberately never shows the "muted" icon unless *all* microphones are muted
@@ -128,9 +206,25 @@ void MicrophoneIndicator::update()
         }
     }
 
-    m_sni->setTitle(i18n("Microphone"));
-    m_sni->setIconByName(iconName);
-    m_sni->setToolTip(QIcon::fromTheme(iconName), allMuted ? i18n("Microphone Muted") : i18n("Microphone"), toolTipForApps(apps));
+    const QString toolTipTitle = allMuted ? i18n("Microphone Muted") : i18n("Microphone");
+    const QString toolTipSubTitle = toolTipForApps();
+
+    // Each of these is a D-Bus signal to the tray host
+    if (iconName != m_iconName) {
+        m_iconName = iconName;
+        m_sni->setIconByName(iconName);
+        m_sni->setToolTipIconByName(iconName);
+    }
+
+    if (toolTipTitle != m_toolTipTitle) {
+        m_toolTipTitle = toolTipTitle;
+        m_sni->setToolTipTitle(toolTipTitle);
+    }
+
+    if (toolTipSubTitle != m_toolTipSubTitle) {
+        m_toolTipSubTitle = toolTipSubTitle;
+        m_sni->setToolTipSubTitle(toolTipSubTitle);
+    }
 
     if (m_muteAction) {
         m_muteAction->setChecked(allMuted);
@@ -144,12 +238,10 @@ void MicrophoneIndicator::update()
 
 bool MicrophoneIndicator::muted() const
 {
-    static const int s_mutedRole = m_sourceModel->role(QByteArrayLiteral("Muted"));
-    Q_ASSERT(s_mutedRole > -1);
+    const auto &sources = Context::instance()->sources().data();
 
-    for (int row = 0; row < m_sourceModel->rowCount(); ++row) {
-        const QModelIndex idx = m_sourceModel->index(row);
-        if (!idx.data(s_mutedRole).toBool()) {
+    for (Source *source : sources) {
+        if (!source->isMuted()) {
             // this is deliberately checking if *all* microphones are muted rather than the preferred one
             return false;
         }
@@ -160,41 +252,38 @@ bool MicrophoneIndicator::muted() const
 
 void MicrophoneIndicator::setMuted(bool muted)
 {
-    static const int s_mutedRole = m_sourceModel->role(QByteArrayLiteral("Muted"));
-    Q_ASSERT(s_mutedRole > -1);
+    const auto &sources = Context::instance()->sources().data();
 
     m_showOsdOnUpdate = true;
 
     if (muted) {
-        for (int row = 0; row < m_sourceModel->rowCount(); ++row) {
-            const QModelIndex idx = m_sourceModel->index(row);
-            if (!idx.data(s_mutedRole).toBool()) {
-                m_sourceModel->setData(idx, true, s_mutedRole);
-                m_mutedIndices.append(QPersistentModelIndex(idx));
-                continue;
+        for (Source *source : sources) {
+            if (!source->isMuted()) {
+                source->setMuted(true);
+                m_mutedSources.append(source);
             }
         }
         return;
     }
 
     // If we didn't mute it, unmute all
-    if (m_mutedIndices.isEmpty()) {
-        for (int i = 0; i < m_sourceModel->rowCount(); ++i) {
-            m_sourceModel->setData(m_sourceModel->index(i), false, s_mutedRole);
+    if (m_mutedSources.isEmpty()) {
+        for (Source *source : sources) {
+            source->setMuted(false);
         }
         return;
     }
 
     // Otherwise unmute the devices we muted
-    for (auto &idx : qAsConst(m_mutedIndices)) {
-        if (!idx.isValid()) {
+    for (const QPointer<Source> &source : qAsConst(m_mutedSources)) {
+        if (!source) {
             continue;
         }
-        m_sourceModel->setData(idx, false, s_mutedRole);
+        source->setMuted(false);
     }
-    m_mutedIndices.clear();
+    m_mutedSources.clear();
 
-    // no update() needed as the model signals a change
+    // no update() needed as the source signals a change
 }
 
 void MicrophoneIndicator::toggleMuted()
@@ -204,7 +293,7 @@ void MicrophoneIndicator::toggleMuted()
 
 void MicrophoneIndicator::adjustVolume(int direction)
 {
-    Source *source = m_sourceModel->defaultSource();
+    Source *source = Context::instance()->server()->defaultSource();
     if (!source) {
         return;
     }
@@ -232,7 +321,7 @@ void MicrophoneIndicator::showOsd()
         m_osd = new VolumeOSD(this);
     }
 
-    auto *preferredSource = m_sourceModel->defaultSource();
+    auto *preferredSource = Context::instance()->server()->defaultSource();
     if (!preferredSource) {
         return;
     }
@@ -240,42 +329,15 @@ void MicrophoneIndicator::showOsd()
     m_osd->showMicrophone(volumePercent(preferredSource));
 }
 
-QVector<QModelIndex> MicrophoneIndicator::recordingApplications() const
-{
-    QVector<QModelIndex> indices;
-
-    // If there are no microphones present, there's nothing to record
-    if (m_sourceModel->rowCount() == 0) {
-        return indices;
-    }
-
-    static const int s_virtualStreamRole = m_sourceOutputModel->role(QByteArrayLiteral("VirtualStream"));
-    Q_ASSERT(s_virtualStreamRole > -1);
-
-    indices.reserve(m_sourceOutputModel->rowCount());
-
-    for (int i = 0; i < m_sourceOutputModel->rowCount(); ++i) {
-        const QModelIndex idx = m_sourceOutputModel->index(i);
-
-        if (idx.data(s_virtualStreamRole).toBool()) {
-            continue;
-        }
-
-        indices.append(idx);
-    }
-
-    return indices;
-}
-
-QString MicrophoneIndicator::toolTipForApps(const QVector<QModelIndex> &apps) const
+QString MicrophoneIndicator::toolTipForApps() const
 {
-    Q_ASSERT(!apps.isEmpty());
+    Q_ASSERT(!m_recording.isEmpty());
 
-    if (apps.count() > 1) {
+    if (m_recording.count() > 1) {
         QStringList names;
-        names.reserve(apps.count());
-        for (const QModelIndex &idx : apps) {
-            names.append(sourceOutputDisplayName(idx));
+        names.reserve(m_recording.count());
+        for (SourceOutput *sourceOutput : m_recording) {
+            names.append(sourceOutputDisplayName(sourceOutput));
         }
         names.removeDuplicates();
         // Still more than one app?
@@ -284,48 +346,24 @@ QString MicrophoneIndicator::toolTipForApps(const QVector<QModelIndex> &apps) co
         }
     }
 
-    const QModelIndex appIdx = apps.constFirst();
+    SourceOutput *app = m_recording.first();
 
     // If there is more than one microphone, show which one is being used.
     // An app could record multiple microphones simultaneously, or the user having the same app running
     // multiple times recording the same microphone, but this isn't covered here for simplicity.
-    if (apps.count() == 1 && m_sourceModel->rowCount() > 1) {
-        static const int s_sourceModelDescriptionRole = m_sourceModel->role(QByteArrayLiteral("Description"));
-        Q_ASSERT(s_sourceModelDescriptionRole > -1);
-        static const int s_sourceModelIndexRole = m_sourceModel->role("Index");
-        Q_ASSERT(s_sourceModelIndexRole > -1);
-
-        static const int s_sourceOutputModelDeviceIndexRole = m_sourceOutputModel->role("DeviceIndex");
-        Q_ASSERT(s_sourceOutputModelDeviceIndexRole > -1);
-
-        const int sourceOutputDeviceIndex = appIdx.data(s_sourceOutputModelDeviceIndexRole).toInt();
-
-        for (int i = 0; i < m_sourceModel->rowCount(); ++i) {
-            const QModelIndex sourceDeviceIdx = m_sourceModel->index(i, 0);
-            const int sourceDeviceIndex = sourceDeviceIdx.data(s_sourceModelIndexRole).toInt();
-
-            if (sourceDeviceIndex == sourceOutputDeviceIndex) {
-                return i18nc("App %1 is using mic with name %2",
-                             "%1 is using the microphone (%2)",
-                             sourceOutputDisplayName(appIdx),
-                             sourceDeviceIdx.data(s_sourceModelDescriptionRole).toString());
-            }
+    const auto &sources = Context::instance()->sources().data();
+    if (m_recording.count() == 1 && sources.count() > 1) {
+        if (Source *source = sources.value(app->deviceIndex())) {
+            return i18nc("App %1 is using mic with name %2", "%1 is using the microphone (%2)", sourceOutputDisplayName(app), source->description());
         }
     }
 
-    return i18nc("App is using mic", "%1 is using the microphone", sourceOutputDisplayName(appIdx));
+    return i18nc("App is using mic", "%1 is using the microphone", sourceOutputDisplayName(app));
 }
 
-QString MicrophoneIndicator::sourceOutputDisplayName(const QModelIndex &idx) const
+QString MicrophoneIndicator::sourceOutputDisplayName(SourceOutput *sourceOutput)
 {
-    Q_ASSERT(idx.model() == m_sourceOutputModel);
-
-    static const int s_nameRole = m_sourceOutputModel->role(QByteArrayLiteral("Name"));
-    Q_ASSERT(s_nameRole > -1);
-    static const int s_clientRole = m_sourceOutputModel->role(QByteArrayLiteral("Client"));
-    Q_ASSERT(s_clientRole > -1);
-
-    auto *client = qobject_cast<Client *>(idx.data(s_clientRole).value<QObject *>());
+    Client *client = sourceOutput->client();
 
-    return client ? client->name() : idx.data(s_nameRole).toString();
+    return client ? client->name() : sourceOutput->name();
 }
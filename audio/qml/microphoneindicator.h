@@ -8,8 +8,8 @@
 
 #pragma once
 
+#include <QMap>
 #include <QObject>
-#include <QPersistentModelIndex>
 #include <QPointer>
 #include <QVector>
 
@@ -23,8 +23,7 @@ class VolumeOSD;
 namespace QPulseAudio
 {
 class Source;
-class SourceModel;
-class SourceOutputModel;
+class SourceOutput;
 }
 
 class MicrophoneIndicator : public QObject
@@ -53,18 +52,28 @@ private:
     static int volumePercent(QPulseAudio::Source *source);
     void showOsd();
 
-    QVector<QModelIndex> recordingApplications() const;
-    QString toolTipForApps(const QVector<QModelIndex> &apps) const;
-    QString sourceOutputDisplayName(const QModelIndex &idx) const;
+    void sourceAdded(int index);
+    void sourceOutputAdded(int index);
+    void sourceOutputAboutToBeRemoved(int index);
+    void updateRecording(QPulseAudio::SourceOutput *sourceOutput);
 
-    QPulseAudio::SourceModel *m_sourceModel = nullptr; // microphone devices
-    QPulseAudio::SourceOutputModel *m_sourceOutputModel = nullptr; // recording streams
+    QString toolTipForApps() const;
+    static QString sourceOutputDisplayName(QPulseAudio::SourceOutput *sourceOutput);
+
+    // Non-virtual recording streams by PulseAudio index, kept up to date from
+    // the context's source output map instead of rescanning it on every change
+    QMap<quint32, QPulseAudio::SourceOutput *> m_recording;
 
     KStatusNotifierItem *m_sni = nullptr;
     QPointer<QAction> m_muteAction;
     QPointer<QAction> m_dontAgainAction;
 
-    QVector<QPersistentModelIndex> m_mutedIndices;
+    // What the status notifier currently shows
+    QString m_iconName;
+    QString m_toolTipTitle;
+    QString m_toolTipSubTitle;
+
+    QVector<QPointer<QPulseAudio::Source>> m_mutedSources;
 
     VolumeOSD *m_osd = nullptr;
     bool m_showOsdOnUpdate = false;
@@ -0,0 +1,373 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "samplecache.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QLocale>
+#include <QPointer>
+#include <QRunnable>
+#include <QSet>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QVector>
+
+#include <pulse/pulseaudio.h>
+#include <sndfile.h>
+
+#include "context.h"
+#include "debug.h"
+
+namespace QPulseAudio
+{
+// Test sounds are a second or two, anything longer isn't one
+static const sf_count_t maxFrames = 10 * 48000;
+
+// Samples uploaded by any SampleCache, removed again with the last one
+static QSet<QByteArray> s_uploadedSamples;
+static int s_cacheCount = 0;
+
+static QByteArray sampleName(const QString &channel)
+{
+    return QByteArrayLiteral("cutefish-speaker-test-") + channel.toLatin1();
+}
+
+static QByteArray eventId(const QString &channel)
+{
+    return QByteArrayLiteral("audio-channel-") + channel.toLatin1();
+}
+
+static void removeSample(const QByteArray &name)
+{
+    pa_context *context = Context::instance()->context();
+    if (!context || pa_context_get_state(context) != PA_CONTEXT_READY) {
+        return;
+    }
+
+    pa_operation *operation = pa_context_remove_sample(context, name.constData(), nullptr, nullptr);
+    if (operation) {
+        pa_operation_unref(operation);
+    }
+}
+
+// Where the sound of eventId is found, following the sound theme spec the
+// way libcanberra's pulse driver resolves it; libcanberra has no public
+// lookup to ask instead. Only the theme libcanberra falls back to when no
+// theme name is set is searched, like the contexts of this plugin.
+class SoundTheme
+{
+public:
+    SoundTheme()
+    {
+        const QStringList dataDirs = QStandardPaths::standardLocations(QStandardPaths::GenericDataLocation);
+        for (const QString &dataDir : dataDirs) {
+            m_soundDirs.append(dataDir + QStringLiteral("/sounds/"));
+        }
+
+        // Most specific locale first, sounds without a locale last
+        const QString locale = QLocale::system().name();
+        m_locales = {locale, locale.section(QLatin1Char('_'), 0, 0), QStringLiteral("C"), QString()};
+        m_locales.removeDuplicates();
+
+        loadTheme(QStringLiteral("freedesktop"));
+    }
+
+    QString find(const QString &eventId) const
+    {
+        static const char *const extensions[] = {".disabled", ".oga", ".ogg", ".wav"};
+
+        // "audio-channel-front-left" falls back to "audio-channel-front" and so on
+        for (QString name = eventId; !name.isEmpty(); name = name.section(QLatin1Char('-'), 0, -2)) {
+            for (const QString &subdir : m_subdirs) {
+                for (const QString &locale : m_locales) {
+                    for (const char *extension : extensions) {
+                        const QString path = subdir + (locale.isEmpty() ? QString() : locale + QLatin1Char('/')) + name + QLatin1String(extension);
+                        if (QFile::exists(path)) {
+                            // A disabled sound isn't played at all
+                            return path.endsWith(QLatin1String(".disabled")) ? QString() : path;
+                        }
+                    }
+                }
+            }
+        }
+
+        return QString();
+    }
+
+private:
+    void loadTheme(const QString &theme)
+    {
+        if (m_themes.contains(theme)) {
+            return;
+        }
+        m_themes.append(theme);
+
+        QStringList inherits;
+        for (const QString &soundDir : qAsConst(m_soundDirs)) {
+            const QString themeDir = soundDir + theme + QLatin1Char('/');
+            QSettings index(themeDir + QStringLiteral("index.theme"), QSettings::IniFormat);
+            const QStringList directories = index.value(QStringLiteral("Sound Theme/Directories")).toStringList();
+            if (directories.isEmpty()) {
+                // Themes without an index keep their sounds at the top
+                m_subdirs.append(themeDir);
+                continue;
+            }
+
+            // The stereo profile is the one libcanberra asks for by default
+            QStringList others;
+            for (const QString &directory : directories) {
+                const QString profile = index.value(directory + QStringLiteral("/OutputProfile"), QStringLiteral("stereo")).toString();
+                (profile == QLatin1String("stereo") ? m_subdirs : others).append(themeDir + directory + QLatin1Char('/'));
+            }
+            m_subdirs.append(others);
+
+            if (inherits.isEmpty()) {
+                inherits = index.value(QStringLiteral("Sound Theme/Inherits")).toStringList();
+            }
+        }
+
+        for (const QString &parent : qAsConst(inherits)) {
+            loadTheme(parent);
+        }
+    }
+
+    QStringList m_soundDirs;
+    QStringList m_locales;
+    QStringList m_themes;
+    // Searched in this order, inherited themes after the ones they extend
+    QStringList m_subdirs;
+};
+
+class DecodeJob : public QRunnable
+{
+public:
+    DecodeJob(SampleCache *cache, const QString &channel)
+        : m_cache(cache)
+        , m_channel(channel)
+    {
+    }
+
+    void run() override
+    {
+        QByteArray samples;
+        int rate = 0;
+
+        static const SoundTheme theme;
+        const QString path = theme.find(QString::fromLatin1(eventId(m_channel)));
+        SF_INFO info = {};
+        SNDFILE *file = path.isEmpty() ? nullptr : sf_open(QFile::encodeName(path).constData(), SFM_READ, &info);
+
+        if (file) {
+            if (info.channels > 0 && info.frames > 0 && info.frames <= maxFrames) {
+                QVector<float> frames(info.frames * info.channels);
+                const sf_count_t count = sf_readf_float(file, frames.data(), info.frames);
+
+                // Mixed down to mono, the channel map of the sample places it
+                samples.resize(count * sizeof(float));
+                float *out = reinterpret_cast<float *>(samples.data());
+                for (sf_count_t i = 0; i < count; ++i) {
+                    float sum = 0;
+                    for (int c = 0; c < info.channels; ++c) {
+                        sum += frames.at(i * info.channels + c);
+                    }
+                    out[i] = sum / info.channels;
+                }
+                rate = info.samplerate;
+            }
+            sf_close(file);
+        }
+
+        // The cache may be gone by now, only look at it on its own thread
+        QMetaObject::invokeMethod(
+            QCoreApplication::instance(),
+            [cache = m_cache, channel = m_channel, samples, rate]() {
+                if (cache) {
+                    cache->decoded(channel, samples, rate);
+                }
+            },
+            Qt::QueuedConnection);
+    }
+
+private:
+    QPointer<SampleCache> m_cache;
+    QString m_channel;
+};
+
+struct SampleUpload {
+    QPointer<SampleCache> cache;
+    QString channel;
+    QByteArray samples;
+    int offset;
+
+    void finish(bool cached)
+    {
+        if (cache) {
+            cache->uploaded(channel, cached);
+        }
+    }
+};
+
+static void uploadWriteCallback(pa_stream *stream, size_t length, void *userdata)
+{
+    auto *upload = static_cast<SampleUpload *>(userdata);
+
+    length = qMin(length, size_t(upload->samples.size() - upload->offset));
+    pa_stream_write(stream, upload->samples.constData() + upload->offset, length, nullptr, 0, PA_SEEK_RELATIVE);
+    upload->offset += length;
+
+    if (upload->offset == upload->samples.size()) {
+        pa_stream_set_write_callback(stream, nullptr, nullptr);
+        pa_stream_finish_upload(stream);
+    }
+}
+
+static void uploadStateCallback(pa_stream *stream, void *userdata)
+{
+    auto *upload = static_cast<SampleUpload *>(userdata);
+
+    const pa_stream_state_t state = pa_stream_get_state(stream);
+    if (state != PA_STREAM_TERMINATED && state != PA_STREAM_FAILED) {
+        return;
+    }
+
+    // Terminated is how a finished upload ends
+    const bool cached = state == PA_STREAM_TERMINATED && upload->offset == upload->samples.size();
+    if (!cached) {
+        qCWarning(PLASMAPA) << "Failed to upload speaker test sample for" << upload->channel;
+    } else if (s_cacheCount == 0) {
+        // Finished after the last cache went away
+        removeSample(sampleName(upload->channel));
+    } else {
+        s_uploadedSamples.insert(sampleName(upload->channel));
+    }
+    upload->finish(cached);
+
+    pa_stream_set_state_callback(stream, nullptr, nullptr);
+    pa_stream_set_write_callback(stream, nullptr, nullptr);
+    pa_stream_unref(stream);
+    delete upload;
+}
+
+SampleCache::SampleCache(QObject *parent)
+    : QObject(parent)
+{
+    Context::instance()->ref();
+    ++s_cacheCount;
+}
+
+SampleCache::~SampleCache()
+{
+    if (--s_cacheCount == 0) {
+        for (const QByteArray &name : qAsConst(s_uploadedSamples)) {
+            removeSample(name);
+        }
+        s_uploadedSamples.clear();
+    }
+    Context::instance()->unref();
+}
+
+void SampleCache::cacheChannel(const QString &channel)
+{
+    if (m_states.contains(channel)) {
+        return;
+    }
+
+    // Another cache uploaded it already
+    if (s_uploadedSamples.contains(sampleName(channel))) {
+        m_states.insert(channel, Cached);
+        return;
+    }
+
+    m_states.insert(channel, Decoding);
+    QThreadPool::globalInstance()->start(new DecodeJob(this, channel));
+}
+
+bool SampleCache::playChannel(const QString &channel, const QString &sinkName)
+{
+    pa_context *context = Context::instance()->context();
+    if (m_states.value(channel, Decoding) != Cached || !context) {
+        return false;
+    }
+
+    pa_proplist *proplist = pa_proplist_new();
+    pa_proplist_sets(proplist, PA_PROP_MEDIA_ROLE, "test");
+    pa_proplist_sets(proplist, PA_PROP_MEDIA_NAME, channel.toLatin1().constData());
+    pa_proplist_sets(proplist, PA_PROP_EVENT_ID, eventId(channel).constData());
+
+    pa_operation *operation =
+        pa_context_play_sample_with_proplist(context, sampleName(channel).constData(), sinkName.toUtf8().constData(), PA_VOLUME_NORM, proplist, nullptr, nullptr);
+    pa_proplist_free(proplist);
+
+    if (!operation) {
+        return false;
+    }
+    pa_operation_unref(operation);
+    return true;
+}
+
+void SampleCache::decoded(const QString &channel, const QByteArray &samples, int rate)
+{
+    pa_context *context = Context::instance()->context();
+    const pa_channel_position_t position = pa_channel_position_from_string(channel.toLatin1().constData());
+
+    pa_sample_spec spec;
+    spec.format = PA_SAMPLE_FLOAT32NE;
+    spec.rate = rate;
+    spec.channels = 1;
+
+    if (samples.isEmpty() || !pa_sample_spec_valid(&spec) || position == PA_CHANNEL_POSITION_INVALID || !context
+        || pa_context_get_state(context) != PA_CONTEXT_READY) {
+        // Left to libcanberra, tried again for the next sink
+        m_states.remove(channel);
+        return;
+    }
+
+    // A single channel at the tested position, so the server never spreads
+    // the sound to the other speakers
+    pa_channel_map map;
+    pa_channel_map_init(&map);
+    map.channels = 1;
+    map.map[0] = position;
+
+    pa_proplist *proplist = pa_proplist_new();
+    pa_proplist_sets(proplist, PA_PROP_MEDIA_ROLE, "test");
+    pa_proplist_sets(proplist, PA_PROP_EVENT_ID, eventId(channel).constData());
+    pa_stream *stream = pa_stream_new_with_proplist(context, sampleName(channel).constData(), &spec, &map, proplist);
+    pa_proplist_free(proplist);
+
+    if (!stream) {
+        qCWarning(PLASMAPA) << "Failed to create upload stream for" << channel;
+        m_states.remove(channel);
+        return;
+    }
+
+    auto *upload = new SampleUpload{this, channel, samples, 0};
+    pa_stream_set_state_callback(stream, uploadStateCallback, upload);
+    pa_stream_set_write_callback(stream, uploadWriteCallback, upload);
+
+    if (pa_stream_connect_upload(stream, samples.size()) < 0) {
+        qCWarning(PLASMAPA) << "Failed to upload speaker test sample for" << channel;
+        pa_stream_set_state_callback(stream, nullptr, nullptr);
+        pa_stream_set_write_callback(stream, nullptr, nullptr);
+        pa_stream_unref(stream);
+        delete upload;
+        m_states.remove(channel);
+        return;
+    }
+
+    m_states.insert(channel, Uploading);
+}
+
+void SampleCache::uploaded(const QString &channel, bool cached)
+{
+    if (cached) {
+        m_states.insert(channel, Cached);
+    } else {
+        m_states.remove(channel);
+    }
+}
+
+}
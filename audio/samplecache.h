@@ -0,0 +1,52 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+
+namespace QPulseAudio
+{
+/**
+ * Speaker test sounds kept in the PulseAudio sample cache.
+ *
+ * Every channel gets its own sample, decoded from the sound theme once and
+ * uploaded as a mono sample placed on that channel. The channel is part of
+ * the sample's channel map, so playing it by name needs no remapping, unlike
+ * libcanberra's forced channel which only applies to streamed sounds.
+ * The samples are shared by all caches and removed from the server along
+ * with the last one.
+ */
+class SampleCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SampleCache(QObject *parent = nullptr);
+    ~SampleCache() override;
+
+    // Decodes and uploads the test sound of channel, if not done yet
+    void cacheChannel(const QString &channel);
+
+    // Plays the uploaded sample of channel on sinkName, false if there is none
+    bool playChannel(const QString &channel, const QString &sinkName);
+
+private:
+    enum State {
+        Decoding,
+        Uploading,
+        Cached,
+    };
+
+    friend class DecodeJob;
+    friend struct SampleUpload;
+    void decoded(const QString &channel, const QByteArray &samples, int rate);
+    void uploaded(const QString &channel, bool cached);
+
+    // Channels without an entry are left to libcanberra
+    QHash<QString, State> m_states;
+};
+
+}
@@ -9,6 +9,17 @@
 
 #include "canberracontext.h"
 
+SpeakerTest::SpeakerTest(QObject *parent)
+    : QObject(parent)
+{
+    QPulseAudio::CanberraContext::instance()->ref();
+}
+
+SpeakerTest::~SpeakerTest()
+{
+    QPulseAudio::CanberraContext::instance()->unref();
+}
+
 QPulseAudio::Sink *SpeakerTest::sink() const
 {
     return m_sink;
@@ -17,13 +28,41 @@ QPulseAudio::Sink *SpeakerTest::sink() const
 void SpeakerTest::setSink(QPulseAudio::Sink *sink)
 {
     if (m_sink != sink) {
+        if (m_sink) {
+            disconnect(m_sink, nullptr, this, nullptr);
+        }
         m_sink = sink;
+        if (m_sink) {
+            connect(m_sink, &QPulseAudio::Sink::rawChannelsChanged, this, &SpeakerTest::cacheChannels);
+            cacheChannels();
+        }
         Q_EMIT sinkChanged();
     }
 }
 
+void SpeakerTest::cacheChannels()
+{
+#if HAVE_SNDFILE
+    const QStringList channels = m_sink->rawChannels();
+    for (const QString &channel : channels) {
+        m_samples.cacheChannel(channel);
+    }
+#endif
+}
+
 void SpeakerTest::testChannel(const QString &name)
 {
+    if (!m_sink) {
+        return;
+    }
+
+#if HAVE_SNDFILE
+    // The cached sample is already decoded and placed on the channel
+    if (m_samples.playChannel(name, m_sink->name())) {
+        return;
+    }
+#endif
+
     auto context = QPulseAudio::CanberraContext::instance()->canberra();
     if (!context) {
         return;
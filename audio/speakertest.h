@@ -7,8 +7,13 @@
 
 #pragma once
 
+#include "config.h"
 #include "sink.h"
 
+#if HAVE_SNDFILE
+#include "samplecache.h"
+#endif
+
 #include <QObject>
 
 class SpeakerTest : public QObject
@@ -16,6 +21,9 @@ class SpeakerTest : public QObject
     Q_OBJECT
     Q_PROPERTY(QPulseAudio::Sink *sink READ sink WRITE setSink NOTIFY sinkChanged)
 public:
+    explicit SpeakerTest(QObject *parent = nullptr);
+    ~SpeakerTest() override;
+
     QPulseAudio::Sink *sink() const;
     void setSink(QPulseAudio::Sink *sink);
     Q_SIGNAL void sinkChanged();
@@ -23,5 +31,10 @@ public:
     Q_INVOKABLE void testChannel(const QString &name);
 
 private:
-    QPulseAudio::Sink *m_sink;
+    void cacheChannels();
+
+    QPulseAudio::Sink *m_sink = nullptr;
+#if HAVE_SNDFILE
+    QPulseAudio::SampleCache m_samples;
+#endif
 };
@@ -6,11 +6,10 @@
  */
 
 #include "bluetoothagent.h"
+#include "pincodedatabase.h"
 
 #include <QDBusObjectPath>
 #include <QFile>
-#include <QStandardPaths>
-#include <QXmlStreamReader>
 
 #include <BluezQt/Device>
 #include <QDebug>
@@ -49,6 +48,7 @@ static int cRandom()
 BluetoothAgent::BluetoothAgent(QObject *parent)
     : BluezQt::Agent(parent)
     , m_fromDatabase(false)
+    , m_database(new PinCodeDatabase(this))
 {
 }
 
@@ -71,65 +71,28 @@ bool BluetoothAgent::isFromDatabase()
 QString BluetoothAgent::getPin(BluezQt::DevicePtr device)
 {
     m_fromDatabase = false;
-    m_pin = QString::number(cRandom());
-    m_pin = m_pin.left(6);
-
-    const QString &xmlPath = QStandardPaths::locate(QStandardPaths::AppDataLocation, QStringLiteral("pin-code-database.xml"));
-
-    QFile file(xmlPath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qDebug() << "Can't open the pin-code-database.xml";
-        return m_pin;
-    }
-
-    QXmlStreamReader xml(&file);
 
     QString deviceType = BluezQt::Device::typeToString(device->type());
     if (deviceType == QLatin1String("audiovideo")) {
         deviceType = QStringLiteral("audio");
     }
 
-    while (!xml.atEnd()) {
-        xml.readNext();
-        if (xml.name() != QLatin1String("device")) {
-            continue;
-        }
-        QXmlStreamAttributes attr = xml.attributes();
-
-        if (attr.count() == 0) {
-            continue;
-        }
-
-        if (attr.hasAttribute(QLatin1String("type")) && attr.value(QLatin1String("type")) != QLatin1String("any")) {
-            if (deviceType != attr.value(QLatin1String("type")).toString()) {
-                continue;
-            }
-        }
+    const QString pin = m_database->pin(deviceType, device->address(), device->name());
 
-        if (attr.hasAttribute(QLatin1String("oui"))) {
-            if (!device->address().startsWith(attr.value(QLatin1String("oui")).toString())) {
-                continue;
-            }
-        }
-
-        if (attr.hasAttribute(QLatin1String("name"))) {
-            if (device->name() != attr.value(QLatin1String("name")).toString()) {
-                continue;
-            }
-        }
-
-        m_pin = attr.value(QLatin1String("pin")).toString();
-        m_fromDatabase = true;
-        if (m_pin.startsWith(QLatin1String("max:"))) {
-            m_fromDatabase = false;
-            int num = m_pin.rightRef(m_pin.length() - 4).toInt();
-            m_pin = QString::number(cRandom()).left(num);
-        }
-
-        qDebug() << "PIN: " << m_pin;
+    if (pin.isNull()) {
+        m_pin = QString::number(cRandom()).left(6);
         return m_pin;
     }
 
+    m_pin = pin;
+    m_fromDatabase = true;
+    if (m_pin.startsWith(QLatin1String("max:"))) {
+        m_fromDatabase = false;
+        int num = m_pin.rightRef(m_pin.length() - 4).toInt();
+        m_pin = QString::number(cRandom()).left(num);
+    }
+
+    qDebug() << "PIN: " << m_pin;
     return m_pin;
 }
 
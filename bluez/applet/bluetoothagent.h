@@ -10,6 +10,8 @@
 
 #include <BluezQt/Agent>
 
+class PinCodeDatabase;
+
 class BluetoothAgent : public BluezQt::Agent
 {
     Q_OBJECT
@@ -38,6 +40,7 @@ Q_SIGNALS:
 private:
     bool m_fromDatabase;
     QString m_pin;
+    PinCodeDatabase *m_database;
 };
 
 #endif // BluetoothAgent_H
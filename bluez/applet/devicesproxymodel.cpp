@@ -20,6 +20,35 @@ DevicesProxyModel::DevicesProxyModel(QObject *parent)
     connect(m_manager, &BluezQt::Manager::bluetoothBlockedChanged, this, &DevicesProxyModel::bluetoothBlockedChanged);
 }
 
+void DevicesProxyModel::setSourceModel(QAbstractItemModel *model)
+{
+    if (sourceModel()) {
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    }
+
+    resetKeys(model);
+
+    // Connected before QSortFilterProxyModel's own handlers so the keys are
+    // up to date by the time rows get filtered and sorted
+    if (model) {
+        connect(model, &QAbstractItemModel::rowsInserted, this, &DevicesProxyModel::sourceRowsInserted);
+        connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &DevicesProxyModel::sourceRowsAboutToBeRemoved);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, &DevicesProxyModel::sourceRowsRemoved);
+        connect(model, &QAbstractItemModel::dataChanged, this, &DevicesProxyModel::sourceDataChanged);
+        connect(model, &QAbstractItemModel::modelReset, this, [this, model]() {
+            resetKeys(model);
+        });
+        connect(model, &QAbstractItemModel::layoutChanged, this, [this, model]() {
+            resetKeys(model);
+        });
+        connect(model, &QAbstractItemModel::rowsMoved, this, [this, model]() {
+            resetKeys(model);
+        });
+    }
+
+    QSortFilterProxyModel::setSourceModel(model);
+}
+
 void DevicesProxyModel::bluetoothBlockedChanged(bool blocked)
 {
     if (blocked){
@@ -69,8 +98,15 @@ QVariant DevicesProxyModel::data(const QModelIndex &index, int role) const
 
 bool DevicesProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
-    bool leftPaired = left.data(BluezQt::DevicesModel::PairedRole).toBool();
-    bool rightPaired = right.data(BluezQt::DevicesModel::PairedRole).toBool();
+    if (left.row() >= m_keys.size() || right.row() >= m_keys.size()) {
+        return QSortFilterProxyModel::lessThan(left, right);
+    }
+
+    const RowKeys &leftKeys = m_keys.at(left.row());
+    const RowKeys &rightKeys = m_keys.at(right.row());
+
+    bool leftPaired = leftKeys.paired;
+    bool rightPaired = rightKeys.paired;
 
     if (leftPaired < rightPaired) {
         return true;
@@ -78,8 +114,8 @@ bool DevicesProxyModel::lessThan(const QModelIndex &left, const QModelIndex &rig
         return false;
     }
 
-    qint16 leftRssi = left.data(BluezQt::DevicesModel::RssiRole).toInt();
-    qint16 rightRssi = right.data(BluezQt::DevicesModel::RssiRole).toInt();
+    qint16 leftRssi = leftKeys.rssi;
+    qint16 rightRssi = rightKeys.rssi;
 
     if (!leftPaired && leftRssi < rightRssi) {
         return true;
@@ -87,10 +123,7 @@ bool DevicesProxyModel::lessThan(const QModelIndex &left, const QModelIndex &rig
         return false;
     }
 
-    const QString &leftName = left.data(BluezQt::DevicesModel::NameRole).toString();
-    const QString &rightName = right.data(BluezQt::DevicesModel::NameRole).toString();
-
-    return QString::localeAwareCompare(leftName, rightName) > 0;
+    return leftKeys.collatedName.compare(rightKeys.collatedName) > 0;
 }
 
 // Returns "hciX" part from UBI "/org/bluez/hciX/dev_xx_xx_xx_xx_xx_xx"
@@ -112,39 +145,130 @@ QString DevicesProxyModel::adapterHciString(const QString &ubi) const
 
 bool DevicesProxyModel::duplicateIndexAddress(const QModelIndex &idx) const
 {
-    const QModelIndexList &list = match(index(0, 0), //
-                                        BluezQt::DevicesModel::AddressRole,
-                                        idx.data(BluezQt::DevicesModel::AddressRole).toString(),
-                                        2,
-                                        Qt::MatchExactly);
-    return list.size() > 1;
+    const int row = mapToSource(idx).row();
+    if (row < 0 || row >= m_keys.size()) {
+        return false;
+    }
+
+    return m_addressCount.value(m_keys.at(row).address) > 1;
 }
 
 bool DevicesProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
 {
-    const QModelIndex index = sourceModel()->index(source_row, 0, source_parent);
+    if (source_parent.isValid() || source_row >= m_keys.size()) {
+        return false;
+    }
 
-    if (index.data(BluezQt::DevicesModel::ConnectedRole).toBool() && index.data(BluezQt::DevicesModel::PairedRole).toBool()){
-        m_connectedName = index.data(BluezQt::DevicesModel::NameRole).toString();
-        m_connectedAdress = index.data(BluezQt::DevicesModel::AddressRole).toString();
+    const RowKeys &keys = m_keys.at(source_row);
+
+    if (keys.connected && keys.paired) {
+        m_connectedName = keys.name;
+        m_connectedAdress = keys.address;
         emit connectedNameChanged(m_connectedName);
         emit connectedAdressChanged(m_connectedAdress);
     }
 
-    if (index.data(BluezQt::DevicesModel::TypeRole).toInt() == 18){
-        return false;
+    const bool accepted = keys.type != 18
+                          && !keys.nameIsAddress
+                          && (keys.paired || keys.rssi != -32768)
+                          && keys.adapterUsable;
+
+    setAccepted(keys, accepted);
+    return accepted;
+}
+
+DevicesProxyModel::RowKeys DevicesProxyModel::rowKeys(const QModelIndex &sourceIndex) const
+{
+    const QString name = sourceIndex.data(BluezQt::DevicesModel::NameRole).toString();
+
+    RowKeys keys(m_collator.sortKey(name));
+    keys.name = name;
+    keys.address = sourceIndex.data(BluezQt::DevicesModel::AddressRole).toString();
+    keys.rssi = sourceIndex.data(BluezQt::DevicesModel::RssiRole).toInt();
+    keys.type = sourceIndex.data(BluezQt::DevicesModel::TypeRole).toInt();
+    keys.connected = sourceIndex.data(BluezQt::DevicesModel::ConnectedRole).toBool();
+    keys.paired = sourceIndex.data(BluezQt::DevicesModel::PairedRole).toBool();
+    keys.nameIsAddress = QString(name).remove(QLatin1Char('-')) == QString(keys.address).remove(QLatin1Char(':'));
+    keys.adapterUsable = sourceIndex.data(BluezQt::DevicesModel::AdapterPoweredRole).toBool()
+                         && sourceIndex.data(BluezQt::DevicesModel::AdapterPairableRole).toBool();
+    return keys;
+}
+
+void DevicesProxyModel::setAccepted(const RowKeys &keys, bool accepted) const
+{
+    if (keys.accepted == accepted) {
+        return;
     }
 
-    if (index.data(BluezQt::DevicesModel::NameRole).toString().replace("-","") == 
-        index.data(BluezQt::DevicesModel::AddressRole).toString().replace(":","")) {
-        return false;
+    keys.accepted = accepted;
+
+    if (accepted) {
+        ++m_addressCount[keys.address];
+    } else if (--m_addressCount[keys.address] <= 0) {
+        m_addressCount.remove(keys.address);
     }
+}
 
-    if (!index.data(BluezQt::DevicesModel::PairedRole).toBool() 
-            && index.data(BluezQt::DevicesModel::RssiRole).toInt() == -32768) {
-        return false;
+void DevicesProxyModel::resetKeys(const QAbstractItemModel *model)
+{
+    m_keys.clear();
+    m_addressCount.clear();
+
+    if (!model) {
+        return;
     }
 
-    return index.data(BluezQt::DevicesModel::AdapterPoweredRole).toBool() &&
-           index.data(BluezQt::DevicesModel::AdapterPairableRole).toBool();
+    const int count = model->rowCount();
+    m_keys.reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+        m_keys.append(rowKeys(model->index(i, 0)));
+    }
+}
+
+void DevicesProxyModel::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    for (int i = first; i <= last; ++i) {
+        m_keys.insert(i, rowKeys(sourceModel()->index(i, 0)));
+    }
+}
+
+void DevicesProxyModel::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    for (int i = first; i <= last && i < m_keys.size(); ++i) {
+        setAccepted(m_keys.at(i), false);
+    }
+}
+
+void DevicesProxyModel::sourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid() || first >= m_keys.size()) {
+        return;
+    }
+
+    m_keys.remove(first, qMin(last, m_keys.size() - 1) - first + 1);
+}
+
+void DevicesProxyModel::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (!topLeft.isValid() || topLeft.parent().isValid()) {
+        return;
+    }
+
+    for (int i = topLeft.row(); i <= bottomRight.row() && i < m_keys.size(); ++i) {
+        // Moves the row's address count over should the address have changed
+        RowKeys &keys = m_keys[i];
+        const bool accepted = keys.accepted;
+        setAccepted(keys, false);
+        keys = rowKeys(sourceModel()->index(i, 0));
+        setAccepted(keys, accepted);
+    }
 }
@@ -8,7 +8,10 @@
 #define DEVICESPROXYMODEL_H
 
 #include <BluezQt/DevicesModel>
+#include <QCollator>
+#include <QHash>
 #include <QSortFilterProxyModel>
+#include <QVector>
 
 class DevicesProxyModel : public QSortFilterProxyModel
 {
@@ -24,6 +27,7 @@ public:
 
     explicit DevicesProxyModel(QObject *parent = nullptr);
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
     QHash<int, QByteArray> roleNames() const override;
     QVariant data(const QModelIndex &index, int role) const override;
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
@@ -42,12 +46,47 @@ private Q_SLOTS:
     void bluetoothBlockedChanged(bool blocked);
 
 private:
+    // Sort and filter inputs of one source row, read once per change
+    // instead of once per comparison
+    struct RowKeys {
+        explicit RowKeys(const QCollatorSortKey &nameKey)
+            : collatedName(nameKey)
+        {
+        }
+
+        QString name;
+        QString address;
+        QCollatorSortKey collatedName;
+        qint16 rssi = 0;
+        int type = 0;
+        bool connected = false;
+        bool paired = false;
+        bool nameIsAddress = false;
+        bool adapterUsable = false;
+        // Whether the row passed the filter the last time it was checked
+        mutable bool accepted = false;
+    };
+
+    RowKeys rowKeys(const QModelIndex &sourceIndex) const;
+    void setAccepted(const RowKeys &keys, bool accepted) const;
+    void resetKeys(const QAbstractItemModel *model);
+
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
     bool duplicateIndexAddress(const QModelIndex &idx) const;
 
     mutable QString m_connectedName = "";
     mutable QString m_connectedAdress = "";
 
     BluezQt::Manager *m_manager;
+
+    QCollator m_collator;
+    QVector<RowKeys> m_keys;
+    // Number of accepted rows per address, > 1 when several adapters see a device
+    mutable QHash<QString, int> m_addressCount;
 };
 
 #endif // DEVICESPROXYMODEL_H
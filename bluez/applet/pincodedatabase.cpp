@@ -0,0 +1,151 @@
+/*
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "pincodedatabase.h"
+
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QStandardPaths>
+#include <QXmlStreamReader>
+
+#include <QDebug>
+
+PinCodeDatabase::PinCodeDatabase(QObject *parent)
+    : QObject(parent)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_loaded(false)
+{
+    // Reloaded lazily, the next pairing picks up the new contents
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this]() {
+        m_loaded = false;
+    });
+}
+
+QString PinCodeDatabase::pin(const QString &type, const QString &address, const QString &name)
+{
+    if (!m_loaded) {
+        load();
+    }
+
+    if (m_nodes.isEmpty()) {
+        return QString();
+    }
+
+    const Constraint constraints[] = {
+        Constraint(type, name),
+        Constraint(type, QString()),
+        Constraint(QString(), name),
+        Constraint(QString(), QString()),
+    };
+
+    int best = -1;
+    int node = 0;
+    int depth = 0;
+
+    while (node != -1) {
+        const Node &current = m_nodes.at(node);
+
+        for (const Constraint &constraint : constraints) {
+            const auto it = current.first.constFind(constraint);
+            if (it != current.first.constEnd() && (best == -1 || it.value() < best)) {
+                best = it.value();
+            }
+        }
+
+        if (depth >= address.size()) {
+            break;
+        }
+
+        node = current.children.value(address.at(depth++), -1);
+    }
+
+    return best == -1 ? QString() : m_pins.at(best);
+}
+
+void PinCodeDatabase::load()
+{
+    const QString path = QStandardPaths::locate(QStandardPaths::AppDataLocation, QStringLiteral("pin-code-database.xml"));
+
+    if (path != m_path && !m_path.isEmpty()) {
+        m_watcher->removePath(m_path);
+    }
+    m_path = path;
+
+    clear();
+
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        // Not marked as loaded, so the file is looked up again next time
+        qDebug() << "Can't open the pin-code-database.xml";
+        return;
+    }
+
+    // Files replaced by a rename drop out of the watcher
+    if (!m_watcher->files().contains(path)) {
+        m_watcher->addPath(path);
+    }
+
+    QXmlStreamReader xml(&file);
+
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement || xml.name() != QLatin1String("device")) {
+            continue;
+        }
+
+        const QXmlStreamAttributes attr = xml.attributes();
+        if (attr.isEmpty()) {
+            continue;
+        }
+
+        QString type = attr.value(QLatin1String("type")).toString();
+        if (type == QLatin1String("any")) {
+            type.clear();
+        }
+
+        // A null pin means "no match", an entry without one still matches
+        QString pin = attr.value(QLatin1String("pin")).toString();
+        if (pin.isNull()) {
+            pin = QLatin1String("");
+        }
+
+        addEntry(type, attr.value(QLatin1String("oui")).toString(), attr.value(QLatin1String("name")).toString(), pin);
+    }
+
+    if (xml.hasError()) {
+        qWarning() << "pin-code-database.xml:" << xml.errorString();
+    }
+
+    m_loaded = true;
+}
+
+void PinCodeDatabase::clear()
+{
+    m_nodes.clear();
+    m_pins.clear();
+    m_nodes.append(Node());
+}
+
+void PinCodeDatabase::addEntry(const QString &type, const QString &oui, const QString &name, const QString &pin)
+{
+    int node = 0;
+
+    for (const QChar &c : oui) {
+        int child = m_nodes.at(node).children.value(c, -1);
+        if (child == -1) {
+            child = m_nodes.size();
+            m_nodes.append(Node());
+            m_nodes[node].children.insert(c, child);
+        }
+        node = child;
+    }
+
+    // Only the first entry of a bucket can ever match, later ones are shadowed
+    QHash<Constraint, int> &first = m_nodes[node].first;
+    const Constraint constraint(type, name);
+    if (!first.contains(constraint)) {
+        first.insert(constraint, m_pins.size());
+    }
+
+    m_pins.append(pin);
+}
@@ -0,0 +1,54 @@
+/*
+ *   SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PINCODEDATABASE_H
+#define PINCODEDATABASE_H
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QVector>
+
+class QFileSystemWatcher;
+
+// In-memory index of pin-code-database.xml.
+//
+// The file is parsed on the first lookup and again after it changed on disk.
+// Entries are stored in a trie over their OUI, each node holding the first
+// entry (in document order) for every (type, name) constraint pair, with an
+// empty string standing for "any". A lookup walks the address once and checks
+// four buckets per node, so it costs O(OUI length) regardless of the number
+// of entries, and still returns the same entry a linear scan would.
+class PinCodeDatabase : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PinCodeDatabase(QObject *parent = nullptr);
+
+    // Returns the pin attribute of the first matching entry, or a null
+    // string when nothing matches or the database is unavailable
+    QString pin(const QString &type, const QString &address, const QString &name);
+
+private:
+    typedef QPair<QString, QString> Constraint;
+
+    struct Node {
+        QHash<QChar, int> children;
+        QHash<Constraint, int> first;
+    };
+
+    void load();
+    void clear();
+    void addEntry(const QString &type, const QString &oui, const QString &name, const QString &pin);
+
+    QFileSystemWatcher *m_watcher;
+    QString m_path;
+    bool m_loaded;
+
+    QVector<Node> m_nodes;
+    QVector<QString> m_pins;
+};
+
+#endif // PINCODEDATABASE_H
@@ -14,6 +14,7 @@
 #include "declarativeinput.h"
 #include "declarativemanager.h"
 #include "declarativemediaplayer.h"
+#include "deviceupdatecoalescer.h"
 
 #include "applet/devicesproxymodel.h"
 #include "applet/bluetoothmanager.h"
@@ -78,6 +79,7 @@ void BluezQtExtensionPlugin::registerTypes(const char *uri)
     qmlRegisterUncreatableType<DeclarativeDevice>(uri, 1, 0, "Device", QStringLiteral("Device cannot be created"));
     qmlRegisterUncreatableType<DeclarativeInput>(uri, 1, 0, "Input", QStringLiteral("Input cannot be created"));
     qmlRegisterUncreatableType<DeclarativeMediaPlayer>(uri, 1, 0, "MediaPlayer", QStringLiteral("MediaPlayer cannot be created"));
+    qmlRegisterUncreatableType<DeviceUpdateCoalescer>(uri, 1, 0, "DeviceUpdatePolicy", QStringLiteral("DeviceUpdatePolicy cannot be created"));
     qmlRegisterUncreatableType<PendingCall>(uri, 1, 0, "PendingCall", QStringLiteral("PendingCall cannot be created"));
     qmlRegisterUncreatableType<Rfkill>(uri, 1, 0, "Rfkill", QStringLiteral("Rfkill cannot be created"));
     qmlRegisterSingletonType(uri, 1, 0, "Services", services_singleton);
@@ -22,7 +22,7 @@ static DeclarativeDevice *devicesAtDeclarativeAdapterFunction(QQmlListProperty<D
     Q_ASSERT(qobject_cast<DeclarativeAdapter *>(property->object));
     DeclarativeAdapter *adapter = static_cast<DeclarativeAdapter *>(property->object);
 
-    return adapter->m_devices.values().at(index);
+    return adapter->m_devices.at(index);
 }
 
 DeclarativeAdapter::DeclarativeAdapter(BluezQt::AdapterPtr adapter, QObject *parent)
@@ -159,7 +159,7 @@ QQmlListProperty<DeclarativeDevice> DeclarativeAdapter::devices()
 
 DeclarativeDevice *DeclarativeAdapter::deviceForAddress(const QString &address) const
 {
-    return declarativeDeviceFromPtr(m_adapter->deviceForAddress(address));
+    return m_devices.valueForAddress(address);
 }
 
 BluezQt::PendingCall *DeclarativeAdapter::startDiscovery()
@@ -194,5 +194,5 @@ DeclarativeDevice *DeclarativeAdapter::declarativeDeviceFromPtr(BluezQt::DeviceP
     if (!ptr) {
         return nullptr;
     }
-    return m_devices.value(ptr->ubi());
+    return m_devices.valueForPtr(ptr.data());
 }
@@ -13,6 +13,8 @@
 
 #include <BluezQt/Adapter>
 
+#include "declarativeregistry.h"
+
 class DeclarativeDevice;
 
 class DeclarativeAdapter : public QObject
@@ -72,7 +74,7 @@ public:
     QQmlListProperty<DeclarativeDevice> devices();
 
     BluezQt::AdapterPtr m_adapter;
-    QHash<QString, DeclarativeDevice *> m_devices;
+    DeclarativeRegistry<DeclarativeDevice> m_devices;
 
 public Q_SLOTS:
     DeclarativeDevice *deviceForAddress(const QString &address) const;
@@ -17,6 +17,7 @@ DeclarativeDevicesModel::DeclarativeDevicesModel(QObject *parent)
     : QSortFilterProxyModel(parent)
     , m_manager(nullptr)
     , m_model(nullptr)
+    , m_coalescer(new DeviceUpdateCoalescer(this))
 {
 }
 
@@ -29,7 +30,13 @@ void DeclarativeDevicesModel::setManager(DeclarativeManager *manager)
 {
     m_manager = manager;
     m_model = new BluezQt::DevicesModel(m_manager, this);
-    setSourceModel(m_model);
+    m_coalescer->setSourceModel(m_model);
+    setSourceModel(m_coalescer);
+}
+
+DeviceUpdateCoalescer *DeclarativeDevicesModel::updatePolicy() const
+{
+    return m_coalescer;
 }
 
 QHash<int, QByteArray> DeclarativeDevicesModel::roleNames() const
@@ -50,7 +57,7 @@ QVariant DeclarativeDevicesModel::data(const QModelIndex &index, int role) const
         return QSortFilterProxyModel::data(index, role);
     }
 
-    BluezQt::DevicePtr dev = m_model->device(mapToSource(index));
+    BluezQt::DevicePtr dev = m_model->device(m_coalescer->mapToSource(mapToSource(index)));
     if (!dev) {
         return QSortFilterProxyModel::data(index, role);
     }
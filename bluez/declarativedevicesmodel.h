@@ -12,6 +12,7 @@
 #include <QSortFilterProxyModel>
 
 #include "declarativemanager.h"
+#include "deviceupdatecoalescer.h"
 
 #include <BluezQt/DevicesModel>
 
@@ -19,6 +20,7 @@ class DeclarativeDevicesModel : public QSortFilterProxyModel
 {
     Q_OBJECT
     Q_PROPERTY(DeclarativeManager *manager READ manager WRITE setManager)
+    Q_PROPERTY(DeviceUpdateCoalescer *updatePolicy READ updatePolicy CONSTANT)
 
 public:
     enum DeclarativeDeviceRoles {
@@ -33,12 +35,15 @@ public:
     DeclarativeManager *manager() const;
     void setManager(DeclarativeManager *manager);
 
+    DeviceUpdateCoalescer *updatePolicy() const;
+
     QHash<int, QByteArray> roleNames() const override;
     QVariant data(const QModelIndex &index, int role) const override;
 
 private:
     DeclarativeManager *m_manager;
     BluezQt::DevicesModel *m_model;
+    DeviceUpdateCoalescer *m_coalescer;
 };
 
 #endif // DECLARATIVEMANAGER_H
@@ -27,7 +27,7 @@ static DeclarativeAdapter *adaptersAtFunction(QQmlListProperty<DeclarativeAdapte
     Q_ASSERT(qobject_cast<DeclarativeManager *>(property->object));
     DeclarativeManager *manager = static_cast<DeclarativeManager *>(property->object);
 
-    return manager->m_adapters.values().at(index);
+    return manager->m_adapters.at(index);
 }
 
 static int devicesCountFunction(QQmlListProperty<DeclarativeDevice> *property)
@@ -43,7 +43,7 @@ static DeclarativeDevice *devicesAtFunction(QQmlListProperty<DeclarativeDevice>
     Q_ASSERT(qobject_cast<DeclarativeManager *>(property->object));
     DeclarativeManager *manager = static_cast<DeclarativeManager *>(property->object);
 
-    return manager->m_devices.values().at(index);
+    return manager->m_devices.at(index);
 }
 
 DeclarativeManager::DeclarativeManager(QObject *parent)
@@ -88,7 +88,7 @@ DeclarativeAdapter *DeclarativeManager::declarativeAdapterFromPtr(BluezQt::Adapt
     if (!ptr) {
         return nullptr;
     }
-    return m_adapters.value(ptr->ubi());
+    return m_adapters.valueForPtr(ptr.data());
 }
 
 DeclarativeDevice *DeclarativeManager::declarativeDeviceFromPtr(BluezQt::DevicePtr ptr) const
@@ -96,27 +96,37 @@ DeclarativeDevice *DeclarativeManager::declarativeDeviceFromPtr(BluezQt::DeviceP
     if (!ptr) {
         return nullptr;
     }
-    return m_devices.value(ptr->ubi());
+    return m_devices.valueForPtr(ptr.data());
 }
 
 DeclarativeAdapter *DeclarativeManager::adapterForAddress(const QString &address) const
 {
-    return declarativeAdapterFromPtr(BluezQt::Manager::adapterForAddress(address));
+    return m_adapters.valueForAddress(address);
 }
 
 DeclarativeAdapter *DeclarativeManager::adapterForUbi(const QString &ubi) const
 {
-    return declarativeAdapterFromPtr(BluezQt::Manager::adapterForUbi(ubi));
+    return m_adapters.value(ubi);
 }
 
 DeclarativeDevice *DeclarativeManager::deviceForAddress(const QString &address) const
 {
-    return declarativeDeviceFromPtr(BluezQt::Manager::deviceForAddress(address));
+    const QVector<DeclarativeDevice *> devices = m_devices.valuesForAddress(address);
+    if (devices.count() > 1) {
+        // Same as BluezQt, prefer the device of the usable adapter
+        DeclarativeAdapter *adapter = usableAdapter();
+        for (DeclarativeDevice *device : devices) {
+            if (device->adapter() == adapter) {
+                return device;
+            }
+        }
+    }
+    return devices.value(0, nullptr);
 }
 
 DeclarativeDevice *DeclarativeManager::deviceForUbi(const QString &ubi) const
 {
-    return declarativeDeviceFromPtr(BluezQt::Manager::deviceForUbi(ubi));
+    return m_devices.value(ubi);
 }
 
 void DeclarativeManager::initJobResult(BluezQt::InitManagerJob *job)
@@ -132,7 +142,7 @@ void DeclarativeManager::initJobResult(BluezQt::InitManagerJob *job)
 void DeclarativeManager::slotAdapterAdded(BluezQt::AdapterPtr adapter)
 {
     DeclarativeAdapter *dAdapter = new DeclarativeAdapter(adapter, this);
-    m_adapters[adapter->ubi()] = dAdapter;
+    m_adapters.insert(dAdapter, adapter.data());
 
     Q_EMIT adapterAdded(dAdapter);
     Q_EMIT adaptersChanged(declarativeAdapters());
@@ -151,8 +161,8 @@ void DeclarativeManager::slotDeviceAdded(BluezQt::DevicePtr device)
 {
     DeclarativeAdapter *dAdapter = declarativeAdapterFromPtr(device->adapter());
     DeclarativeDevice *dDevice = new DeclarativeDevice(device, dAdapter);
-    m_devices[device->ubi()] = dDevice;
-    dAdapter->m_devices[device->ubi()] = dDevice;
+    m_devices.insert(dDevice, device.data());
+    dAdapter->m_devices.insert(dDevice, device.data());
 
     Q_EMIT deviceAdded(dDevice);
     Q_EMIT devicesChanged(declarativeDevices());
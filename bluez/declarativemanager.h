@@ -14,6 +14,8 @@
 
 #include <BluezQt/Manager>
 
+#include "declarativeregistry.h"
+
 class DeclarativeDevice;
 class DeclarativeAdapter;
 
@@ -34,8 +36,8 @@ public:
     DeclarativeAdapter *declarativeAdapterFromPtr(BluezQt::AdapterPtr ptr) const;
     DeclarativeDevice *declarativeDeviceFromPtr(BluezQt::DevicePtr ptr) const;
 
-    QHash<QString, DeclarativeAdapter *> m_adapters;
-    QHash<QString, DeclarativeDevice *> m_devices;
+    DeclarativeRegistry<DeclarativeAdapter> m_adapters;
+    DeclarativeRegistry<DeclarativeDevice> m_devices;
 
 public Q_SLOTS:
     DeclarativeAdapter *adapterForAddress(const QString &address) const;
@@ -0,0 +1,120 @@
+/*
+ * BluezQt - Asynchronous Bluez wrapper library
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ */
+
+#ifndef DECLARATIVEREGISTRY_H
+#define DECLARATIVEREGISTRY_H
+
+#include <QHash>
+#include <QMultiHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * Declarative objects stored contiguously, for O(1) indexed access from
+ * QQmlListProperty, with hash indexes by UBI, address and BluezQt object.
+ *
+ * Removal swaps the last item into the freed slot, so the order is
+ * not stable, just like the QHash it replaces.
+ */
+template<typename T>
+class DeclarativeRegistry
+{
+public:
+    int count() const
+    {
+        return m_items.count();
+    }
+
+    T *at(int index) const
+    {
+        return m_items.at(index).item;
+    }
+
+    T *value(const QString &ubi) const
+    {
+        const int index = m_byUbi.value(ubi, -1);
+        return index < 0 ? nullptr : m_items.at(index).item;
+    }
+
+    T *valueForPtr(const void *ptr) const
+    {
+        const int index = m_byPtr.value(ptr, -1);
+        return index < 0 ? nullptr : m_items.at(index).item;
+    }
+
+    T *valueForAddress(const QString &address) const
+    {
+        const int index = m_byAddress.value(address, -1);
+        return index < 0 ? nullptr : m_items.at(index).item;
+    }
+
+    // The same device may be known by several adapters
+    QVector<T *> valuesForAddress(const QString &address) const
+    {
+        QVector<T *> result;
+        for (auto it = m_byAddress.constFind(address); it != m_byAddress.constEnd() && it.key() == address; ++it) {
+            result.append(m_items.at(it.value()).item);
+        }
+        return result;
+    }
+
+    void insert(T *item, const void *ptr)
+    {
+        const int index = m_items.count();
+        m_items.append(Entry{item, ptr, item->ubi(), item->address()});
+        addIndexes(m_items.last(), index);
+    }
+
+    T *take(const QString &ubi)
+    {
+        const int index = m_byUbi.value(ubi, -1);
+        if (index < 0) {
+            return nullptr;
+        }
+
+        const Entry entry = m_items.at(index);
+        removeIndexes(entry, index);
+
+        const int last = m_items.count() - 1;
+        if (index != last) {
+            removeIndexes(m_items.at(last), last);
+            m_items[index] = m_items.at(last);
+            addIndexes(m_items.at(index), index);
+        }
+        m_items.removeLast();
+
+        return entry.item;
+    }
+
+private:
+    struct Entry {
+        T *item;
+        const void *ptr;
+        QString ubi;
+        QString address;
+    };
+
+    void addIndexes(const Entry &entry, int index)
+    {
+        m_byUbi.insert(entry.ubi, index);
+        m_byPtr.insert(entry.ptr, index);
+        m_byAddress.insert(entry.address, index);
+    }
+
+    void removeIndexes(const Entry &entry, int index)
+    {
+        m_byUbi.remove(entry.ubi);
+        m_byPtr.remove(entry.ptr);
+        m_byAddress.remove(entry.address, index);
+    }
+
+    QVector<Entry> m_items;
+    QHash<QString, int> m_byUbi;
+    QHash<const void *, int> m_byPtr;
+    QMultiHash<QString, int> m_byAddress;
+};
+
+#endif // DECLARATIVEREGISTRY_H
@@ -0,0 +1,375 @@
+/*
+ * BluezQt - Asynchronous Bluez wrapper library
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ */
+
+#include "deviceupdatecoalescer.h"
+
+#include <QTimer>
+
+#include <BluezQt/DevicesModel>
+
+DeviceUpdateCoalescer::DeviceUpdateCoalescer(QObject *parent)
+    : QIdentityProxyModel(parent)
+    , m_enabled(true)
+    , m_rssiStep(5)
+    , m_rssiInterval(1000)
+    , m_debounceInterval(250)
+    , m_timer(new QTimer(this))
+    , m_timerDueAt(-1)
+{
+    m_clock.start();
+
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, [this]() {
+        m_timerDueAt = -1;
+        processPending();
+    });
+}
+
+bool DeviceUpdateCoalescer::isEnabled() const
+{
+    return m_enabled;
+}
+
+void DeviceUpdateCoalescer::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) {
+        return;
+    }
+
+    if (m_enabled) {
+        flush();
+    }
+
+    m_enabled = enabled;
+
+    // Snapshots went stale while changes were passed through
+    if (m_enabled) {
+        reset();
+    }
+
+    Q_EMIT enabledChanged(m_enabled);
+}
+
+int DeviceUpdateCoalescer::rssiStep() const
+{
+    return m_rssiStep;
+}
+
+void DeviceUpdateCoalescer::setRssiStep(int step)
+{
+    step = qMax(1, step);
+
+    if (m_rssiStep != step) {
+        m_rssiStep = step;
+        Q_EMIT rssiStepChanged(m_rssiStep);
+    }
+}
+
+int DeviceUpdateCoalescer::rssiInterval() const
+{
+    return m_rssiInterval;
+}
+
+void DeviceUpdateCoalescer::setRssiInterval(int msec)
+{
+    msec = qMax(0, msec);
+
+    if (m_rssiInterval != msec) {
+        m_rssiInterval = msec;
+        Q_EMIT rssiIntervalChanged(m_rssiInterval);
+    }
+}
+
+int DeviceUpdateCoalescer::debounceInterval() const
+{
+    return m_debounceInterval;
+}
+
+void DeviceUpdateCoalescer::setDebounceInterval(int msec)
+{
+    msec = qMax(0, msec);
+
+    if (m_debounceInterval != msec) {
+        m_debounceInterval = msec;
+        Q_EMIT debounceIntervalChanged(m_debounceInterval);
+    }
+}
+
+void DeviceUpdateCoalescer::setSourceModel(QAbstractItemModel *model)
+{
+    if (sourceModel()) {
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    }
+
+    QIdentityProxyModel::setSourceModel(model);
+
+    m_rows.clear();
+    m_roles.clear();
+    m_timer->stop();
+    m_timerDueAt = -1;
+
+    if (!model) {
+        return;
+    }
+
+    // dataChanged is re-emitted by us according to the role policies
+    disconnect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex, QVector<int>)), this, nullptr);
+
+    connect(model, &QAbstractItemModel::dataChanged, this, &DeviceUpdateCoalescer::sourceDataChanged);
+    connect(model, &QAbstractItemModel::rowsInserted, this, &DeviceUpdateCoalescer::sourceRowsInserted);
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &DeviceUpdateCoalescer::sourceRowsAboutToBeRemoved);
+    connect(model, &QAbstractItemModel::modelReset, this, &DeviceUpdateCoalescer::reset);
+
+    const QList<int> roles = model->roleNames().keys();
+    for (int role : roles) {
+        if (role != BluezQt::DevicesModel::UbiRole) {
+            m_roles.append(role);
+        }
+    }
+
+    reset();
+}
+
+QVariant DeviceUpdateCoalescer::data(const QModelIndex &index, int role) const
+{
+    if (m_enabled && policy(role) != Immediate && index.isValid()) {
+        const QString ubi = QIdentityProxyModel::data(index, BluezQt::DevicesModel::UbiRole).toString();
+        const auto it = m_rows.constFind(ubi);
+        if (it != m_rows.constEnd()) {
+            const auto value = it->published.constFind(role);
+            if (value != it->published.constEnd()) {
+                return value.value();
+            }
+        }
+    }
+
+    return QIdentityProxyModel::data(index, role);
+}
+
+void DeviceUpdateCoalescer::flush()
+{
+    m_timer->stop();
+    m_timerDueAt = -1;
+
+    for (Row &row : m_rows) {
+        if (row.rssiDueAt < 0 && row.cosmeticDueAt < 0) {
+            continue;
+        }
+
+        QVector<int> roles = changedRoles(row, Rssi);
+        roles += changedRoles(row, Debounced);
+        row.rssiDueAt = -1;
+        row.cosmeticDueAt = -1;
+        publish(row, roles);
+    }
+}
+
+DeviceUpdateCoalescer::Policy DeviceUpdateCoalescer::policy(int role)
+{
+    switch (role) {
+    case BluezQt::DevicesModel::RssiRole:
+        return Rssi;
+    case Qt::DisplayRole:
+    case BluezQt::DevicesModel::NameRole:
+    case BluezQt::DevicesModel::FriendlyNameRole:
+    case BluezQt::DevicesModel::RemoteNameRole:
+    case BluezQt::DevicesModel::ClassRole:
+    case BluezQt::DevicesModel::TypeRole:
+    case BluezQt::DevicesModel::AppearanceRole:
+    case BluezQt::DevicesModel::IconRole:
+    case BluezQt::DevicesModel::UuidsRole:
+    case BluezQt::DevicesModel::ModaliasRole:
+        return Debounced;
+    default:
+        return Immediate;
+    }
+}
+
+int DeviceUpdateCoalescer::rssiBucket(const QVariant &rssi) const
+{
+    // BlueZ reports -32768 (no RSSI) for devices out of range
+    const int value = rssi.toInt();
+    return value >= 0 ? value / m_rssiStep : -((-value + m_rssiStep - 1) / m_rssiStep);
+}
+
+void DeviceUpdateCoalescer::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    if (!topLeft.isValid() || !bottomRight.isValid()) {
+        return;
+    }
+
+    if (!m_enabled) {
+        Q_EMIT dataChanged(mapFromSource(topLeft), mapFromSource(bottomRight), roles);
+        return;
+    }
+
+    for (int i = topLeft.row(); i <= bottomRight.row(); ++i) {
+        updateRow(sourceModel()->index(i, 0, topLeft.parent()));
+    }
+}
+
+void DeviceUpdateCoalescer::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    for (int i = first; i <= last; ++i) {
+        trackRow(sourceModel()->index(i, 0, parent));
+    }
+}
+
+void DeviceUpdateCoalescer::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    for (int i = first; i <= last; ++i) {
+        m_rows.remove(sourceModel()->index(i, 0, parent).data(BluezQt::DevicesModel::UbiRole).toString());
+    }
+}
+
+void DeviceUpdateCoalescer::reset()
+{
+    m_rows.clear();
+
+    const int count = sourceModel() ? sourceModel()->rowCount() : 0;
+    for (int i = 0; i < count; ++i) {
+        trackRow(sourceModel()->index(i, 0));
+    }
+}
+
+void DeviceUpdateCoalescer::trackRow(const QModelIndex &sourceIndex)
+{
+    Row &row = m_rows[sourceIndex.data(BluezQt::DevicesModel::UbiRole).toString()];
+    row = Row();
+    row.index = sourceIndex;
+
+    for (int role : qAsConst(m_roles)) {
+        row.published.insert(role, sourceIndex.data(role));
+    }
+}
+
+void DeviceUpdateCoalescer::updateRow(const QModelIndex &sourceIndex)
+{
+    const QString ubi = sourceIndex.data(BluezQt::DevicesModel::UbiRole).toString();
+    auto it = m_rows.find(ubi);
+    if (it == m_rows.end()) {
+        trackRow(sourceIndex);
+        const QModelIndex index = mapFromSource(sourceIndex);
+        Q_EMIT dataChanged(index, index);
+        return;
+    }
+
+    Row &row = it.value();
+    const QVector<int> immediate = changedRoles(row, Immediate);
+    const QVector<int> rssi = changedRoles(row, Rssi);
+    const QVector<int> cosmetic = changedRoles(row, Debounced);
+
+    // Connection state can't wait; anything pending for the row goes along
+    if (!immediate.isEmpty()) {
+        row.rssiDueAt = -1;
+        row.cosmeticDueAt = -1;
+        publish(row, immediate + rssi + cosmetic);
+        return;
+    }
+
+    const qint64 now = m_clock.elapsed();
+
+    if (!rssi.isEmpty() && row.rssiDueAt < 0) {
+        if (row.rssiPublishedAt < 0 || now - row.rssiPublishedAt >= m_rssiInterval) {
+            publish(row, rssi);
+        } else {
+            row.rssiDueAt = row.rssiPublishedAt + m_rssiInterval;
+            scheduleFlush(row.rssiDueAt);
+        }
+    }
+
+    if (!cosmetic.isEmpty()) {
+        row.cosmeticDueAt = now + m_debounceInterval;
+        scheduleFlush(row.cosmeticDueAt);
+    }
+}
+
+QVector<int> DeviceUpdateCoalescer::changedRoles(const Row &row, Policy rolePolicy) const
+{
+    QVector<int> roles;
+
+    for (int role : qAsConst(m_roles)) {
+        if (policy(role) != rolePolicy) {
+            continue;
+        }
+
+        const QVariant current = row.index.data(role);
+        const QVariant published = row.published.value(role);
+
+        if (rolePolicy == Rssi) {
+            if (rssiBucket(current) != rssiBucket(published)) {
+                roles.append(role);
+            }
+        } else if (current != published) {
+            roles.append(role);
+        }
+    }
+
+    return roles;
+}
+
+void DeviceUpdateCoalescer::publish(Row &row, const QVector<int> &roles)
+{
+    if (roles.isEmpty() || !row.index.isValid()) {
+        return;
+    }
+
+    for (int role : roles) {
+        row.published.insert(role, row.index.data(role));
+    }
+
+    if (roles.contains(BluezQt::DevicesModel::RssiRole)) {
+        row.rssiPublishedAt = m_clock.elapsed();
+    }
+
+    const QModelIndex index = mapFromSource(row.index);
+    Q_EMIT dataChanged(index, index, roles);
+}
+
+void DeviceUpdateCoalescer::processPending()
+{
+    const qint64 now = m_clock.elapsed();
+    qint64 next = -1;
+
+    for (Row &row : m_rows) {
+        QVector<int> roles;
+
+        if (row.rssiDueAt >= 0) {
+            if (row.rssiDueAt <= now) {
+                // Re-diffed: RSSI may have settled back into the published bucket
+                roles += changedRoles(row, Rssi);
+                row.rssiDueAt = -1;
+            } else if (next < 0 || row.rssiDueAt < next) {
+                next = row.rssiDueAt;
+            }
+        }
+
+        if (row.cosmeticDueAt >= 0) {
+            if (row.cosmeticDueAt <= now) {
+                roles += changedRoles(row, Debounced);
+                row.cosmeticDueAt = -1;
+            } else if (next < 0 || row.cosmeticDueAt < next) {
+                next = row.cosmeticDueAt;
+            }
+        }
+
+        publish(row, roles);
+    }
+
+    if (next >= 0) {
+        scheduleFlush(next);
+    }
+}
+
+void DeviceUpdateCoalescer::scheduleFlush(qint64 dueAt)
+{
+    if (m_timer->isActive() && m_timerDueAt <= dueAt) {
+        return;
+    }
+
+    m_timerDueAt = dueAt;
+    m_timer->start(int(qMax<qint64>(0, dueAt - m_clock.elapsed())));
+}
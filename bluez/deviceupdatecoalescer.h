@@ -0,0 +1,105 @@
+/*
+ * BluezQt - Asynchronous Bluez wrapper library
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ */
+
+#ifndef DEVICEUPDATECOALESCER_H
+#define DEVICEUPDATECOALESCER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QIdentityProxyModel>
+#include <QPersistentModelIndex>
+#include <QVariant>
+
+class QTimer;
+
+// Sits between BluezQt::DevicesModel and the sorting proxies. The source
+// model reports every device property change as a role-less dataChanged,
+// which during discovery means several re-sorts per advertiser per second.
+// Rows are diffed against the last published values and each role is
+// handled by its policy:
+//  - RSSI is bucketed to rssiStep dBm and published at most every rssiInterval ms
+//  - cosmetic roles (names, icon, class, uuids, ...) are debounced by debounceInterval ms
+//  - everything else (paired, connected, trusted, adapter state, ...) is passed
+//    through immediately, together with whatever was still pending for the row
+// Changes that touch no model role at all (ManufacturerData, ServiceData) are dropped.
+class DeviceUpdateCoalescer : public QIdentityProxyModel
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(int rssiStep READ rssiStep WRITE setRssiStep NOTIFY rssiStepChanged)
+    Q_PROPERTY(int rssiInterval READ rssiInterval WRITE setRssiInterval NOTIFY rssiIntervalChanged)
+    Q_PROPERTY(int debounceInterval READ debounceInterval WRITE setDebounceInterval NOTIFY debounceIntervalChanged)
+
+public:
+    explicit DeviceUpdateCoalescer(QObject *parent = nullptr);
+
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+
+    int rssiStep() const;
+    void setRssiStep(int step);
+
+    int rssiInterval() const;
+    void setRssiInterval(int msec);
+
+    int debounceInterval() const;
+    void setDebounceInterval(int msec);
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    // Publishes everything that is still held back
+    Q_INVOKABLE void flush();
+
+Q_SIGNALS:
+    void enabledChanged(bool enabled);
+    void rssiStepChanged(int step);
+    void rssiIntervalChanged(int msec);
+    void debounceIntervalChanged(int msec);
+
+private:
+    enum Policy {
+        Immediate,
+        Rssi,
+        Debounced,
+    };
+
+    struct Row {
+        QPersistentModelIndex index;
+        QHash<int, QVariant> published;
+        qint64 rssiPublishedAt = -1;
+        qint64 rssiDueAt = -1;
+        qint64 cosmeticDueAt = -1;
+    };
+
+    static Policy policy(int role);
+    int rssiBucket(const QVariant &rssi) const;
+
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void reset();
+
+    void trackRow(const QModelIndex &sourceIndex);
+    void updateRow(const QModelIndex &sourceIndex);
+    QVector<int> changedRoles(const Row &row, Policy policy) const;
+    void publish(Row &row, const QVector<int> &roles);
+    void processPending();
+    void scheduleFlush(qint64 dueAt);
+
+    bool m_enabled;
+    int m_rssiStep;
+    int m_rssiInterval;
+    int m_debounceInterval;
+
+    QVector<int> m_roles;
+    QHash<QString, Row> m_rows;
+    QElapsedTimer m_clock;
+    QTimer *m_timer;
+    qint64 m_timerDueAt;
+};
+
+#endif // DEVICEUPDATECOALESCER_H
@@ -25,6 +25,8 @@
 
 #include "mpris.h"
 
+#include "mprisartprovider.h"
+
 #include <QQmlEngine>
 #include <QJSEngine>
 
@@ -52,6 +54,11 @@ QString Mpris::metadataToString(Mpris::Metadata metadata)
     return enumerationToString(metadata);
 }
 
+QString Mpris::artImageSource(const QString &artUrl)
+{
+    return MprisArtProvider::imageSource(artUrl);
+}
+
 
 // Private
 
@@ -89,6 +89,9 @@ public:
 
     Q_INVOKABLE static QString metadataToString(Metadata metadata);
 
+    // Image source serving artUrl from the shared, downscaled art cache
+    Q_INVOKABLE static QString artImageSource(const QString &artUrl);
+
 private:
     template<class T, int N> static int arraySize(T (&)[N]) { return N; };
     template<typename T, typename U> struct is_same { static const bool value = false; };
@@ -0,0 +1,320 @@
+// -*- c++ -*-
+
+/*!
+ *
+ * Copyright (C) 2015 Jolla Ltd.
+ *
+ * Contact: Valerio Valerio <valerio.valerio@jolla.com>
+ * Author: Andres Gomez <andres.gomez@jolla.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+#include "mprisartprovider.h"
+
+#include <QImage>
+#include <QImageReader>
+#include <QQuickTextureFactory>
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCache>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+#include <QtCore/QUrl>
+#include <QtCore/QVector>
+
+// Covers are shown as thumbnails, never decode beyond this unless asked to
+static const int defaultArtSize = 512;
+// Cache budget, in KiB
+static const int artCacheCost = 32 * 1024;
+
+const QString MprisArtProvider::providerId = QStringLiteral("mprisart");
+
+namespace {
+
+class ArtResponse;
+
+class ArtCache
+{
+public:
+    ArtCache()
+    {
+        m_images.setMaxCost(artCacheCost);
+    }
+
+    bool find(const QString &key, QImage *image)
+    {
+        QMutexLocker locker(&m_mutex);
+        const QImage *cached = m_images.object(key);
+        if (!cached) {
+            return false;
+        }
+
+        *image = *cached;
+        return true;
+    }
+
+    void insert(const QString &key, const QImage &image)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_images.insert(key, new QImage(image), qMax(1, int(image.sizeInBytes() / 1024)));
+    }
+
+    // Adds response to the decode running for request, returns true if
+    // there is none yet and the caller has to start it
+    bool attach(const QString &request, ArtResponse *response)
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_pending.find(request);
+        const bool start = it == m_pending.end();
+        if (start) {
+            it = m_pending.insert(request, QVector<ArtResponse *>());
+        }
+        it->append(response);
+        return start;
+    }
+
+    void detach(const QString &request, ArtResponse *response)
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_pending.find(request);
+        if (it != m_pending.end()) {
+            it->removeOne(response);
+        }
+    }
+
+    void finish(const QString &request, const QImage &image, const QString &errorString);
+
+private:
+    QMutex m_mutex;
+    QCache<QString, QImage> m_images;
+    // Responses waiting on a decode, by art URL and requested size
+    QHash<QString, QVector<ArtResponse *>> m_pending;
+};
+
+Q_GLOBAL_STATIC(ArtCache, artCache)
+
+// Handed to the engine, which may delete it at any time. It never runs
+// on the pool, the decode posts its result to it instead.
+class ArtResponse : public QQuickImageResponse
+{
+public:
+    explicit ArtResponse(const QString &request)
+        : m_request(request)
+    {
+    }
+
+    ~ArtResponse() override
+    {
+        if (!artCache.isDestroyed()) {
+            artCache()->detach(m_request, this);
+        }
+    }
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(m_image);
+    }
+
+    QString errorString() const override
+    {
+        return m_errorString;
+    }
+
+    void setResult(const QImage &image, const QString &errorString)
+    {
+        m_image = image;
+        m_errorString = errorString;
+        Q_EMIT finished();
+    }
+
+private:
+    QString m_request;
+    QImage m_image;
+    QString m_errorString;
+};
+
+void ArtCache::finish(const QString &request, const QImage &image, const QString &errorString)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Responses unregister under the same lock in their destructor, so all
+    // of them are still alive here. A queued call is dropped if its
+    // response is deleted before it is delivered.
+    const QVector<ArtResponse *> responses = m_pending.take(request);
+    for (ArtResponse *response : responses) {
+        QMetaObject::invokeMethod(
+            response,
+            [response, image, errorString]() {
+                response->setResult(image, errorString);
+            },
+            Qt::QueuedConnection);
+    }
+}
+
+class ArtDecoder : public QRunnable
+{
+public:
+    ArtDecoder(const QString &request, const QString &artUrl, const QSize &requestedSize)
+        : m_request(request)
+        , m_artUrl(artUrl)
+        , m_requestedSize(requestedSize)
+    {
+    }
+
+    void run() override
+    {
+        load();
+        artCache()->finish(m_request, m_image, m_errorString);
+    }
+
+private:
+    void load();
+    QSize targetSize(const QSize &sourceSize) const;
+
+    QString m_request;
+    QString m_artUrl;
+    QSize m_requestedSize;
+    QImage m_image;
+    QString m_errorString;
+};
+
+QSize ArtDecoder::targetSize(const QSize &sourceSize) const
+{
+    QSize bounds = m_requestedSize;
+    if (bounds.width() <= 0 && bounds.height() <= 0) {
+        bounds = QSize(defaultArtSize, defaultArtSize);
+    } else if (bounds.width() <= 0) {
+        bounds.setWidth(sourceSize.width());
+    } else if (bounds.height() <= 0) {
+        bounds.setHeight(sourceSize.height());
+    }
+
+    if (!sourceSize.isValid()
+        || (sourceSize.width() <= bounds.width() && sourceSize.height() <= bounds.height())) {
+        return sourceSize;
+    }
+
+    return sourceSize.scaled(bounds, Qt::KeepAspectRatio);
+}
+
+void ArtDecoder::load()
+{
+    const QUrl url(m_artUrl);
+    QByteArray data;
+    QString key;
+
+    if (url.isLocalFile()) {
+        const QFileInfo info(url.toLocalFile());
+        if (!info.isFile()) {
+            m_errorString = QStringLiteral("No such file: %1").arg(info.filePath());
+            return;
+        }
+
+        // Browsers reuse their temporary file names for different covers
+        key = info.filePath()
+            + QLatin1Char('@') + QString::number(info.lastModified().toMSecsSinceEpoch())
+            + QLatin1Char(':') + QString::number(info.size());
+    } else if (url.scheme() == QLatin1String("data")) {
+        // Kept percent-encoded (so plain ASCII) and decoded exactly once below
+        const QByteArray path = url.path(QUrl::FullyEncoded).toLatin1();
+        const int comma = path.indexOf(',');
+        if (comma < 0) {
+            m_errorString = QStringLiteral("Malformed data URI");
+            return;
+        }
+
+        const QByteArray payload = QByteArray::fromPercentEncoding(path.mid(comma + 1));
+        data = path.left(comma).endsWith(";base64")
+            ? QByteArray::fromBase64(payload)
+            : payload;
+        key = QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex());
+    } else {
+        m_errorString = QStringLiteral("Unsupported art URL scheme: %1").arg(url.scheme());
+        return;
+    }
+
+    key += QLatin1Char('/') + QString::number(m_requestedSize.width())
+        + QLatin1Char('x') + QString::number(m_requestedSize.height());
+
+    if (artCache()->find(key, &m_image)) {
+        return;
+    }
+
+    QBuffer buffer(&data);
+    QImageReader reader;
+    if (url.isLocalFile()) {
+        reader.setFileName(url.toLocalFile());
+    } else {
+        reader.setDevice(&buffer);
+    }
+
+    // Let the decoder scale, JPEG can skip most of the work that way
+    const QSize size = targetSize(reader.size());
+    if (size.isValid()) {
+        reader.setScaledSize(size);
+    }
+
+    if (!reader.read(&m_image)) {
+        m_errorString = reader.errorString();
+        return;
+    }
+
+    artCache()->insert(key, m_image);
+}
+
+}
+
+
+MprisArtProvider::MprisArtProvider()
+    : QQuickAsyncImageProvider()
+{
+}
+
+MprisArtProvider::~MprisArtProvider()
+{
+}
+
+QQuickImageResponse *MprisArtProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    const QString artUrl = QUrl::fromPercentEncoding(id.toUtf8());
+    const QString request = artUrl + QLatin1Char('/') + QString::number(requestedSize.width())
+        + QLatin1Char('x') + QString::number(requestedSize.height());
+
+    // Views asking for the same cover at the same size share one decode
+    ArtResponse *response = new ArtResponse(request);
+    if (artCache()->attach(request, response)) {
+        QThreadPool::globalInstance()->start(new ArtDecoder(request, artUrl, requestedSize));
+    }
+    return response;
+}
+
+QString MprisArtProvider::imageSource(const QString &artUrl)
+{
+    if (artUrl.isEmpty()) {
+        return QString();
+    }
+
+    return QStringLiteral("image://") + providerId + QLatin1Char('/')
+        + QString::fromLatin1(QUrl::toPercentEncoding(artUrl));
+}
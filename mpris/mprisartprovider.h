@@ -0,0 +1,59 @@
+// -*- c++ -*-
+
+/*!
+ *
+ * Copyright (C) 2015 Jolla Ltd.
+ *
+ * Contact: Valerio Valerio <valerio.valerio@jolla.com>
+ * Author: Andres Gomez <andres.gomez@jolla.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+#ifndef MPRISARTPROVIDER_H
+#define MPRISARTPROVIDER_H
+
+#include "mprisqt.h"
+
+#include <QQuickAsyncImageProvider>
+
+#include <QtCore/QString>
+#include <QtCore/QSize>
+
+/*
+ * Serves mpris:artUrl images as "image://mprisart/<percent encoded url>".
+ *
+ * Images are decoded and downscaled on the global thread pool and kept
+ * in a bounded cache shared by every engine in the process, so all the
+ * views showing the same cover pay for a single decode. Local files are
+ * keyed by path and modification time, data: URIs by a hash of their
+ * content.
+ */
+class MPRIS_QT_EXPORT MprisArtProvider : public QQuickAsyncImageProvider
+{
+public:
+    static const QString providerId;
+
+    MprisArtProvider();
+    ~MprisArtProvider();
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+    static QString imageSource(const QString &artUrl);
+};
+
+#endif /* MPRISARTPROVIDER_H */
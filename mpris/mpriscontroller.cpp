@@ -29,9 +29,12 @@
 
 #include <QDBusConnection>
 #include <QDBusPendingReply>
-#include <QDBusPendingCallWatcher>
+
+#include <QtCore/QTimer>
 
 static const QString mprisObjectPath = QStringLiteral("/org/mpris/MediaPlayer2");
+static const QString positionProperty = QStringLiteral("Position");
+static const int positionDriftCheckInterval = 5000;
 
 MprisController::MprisController(const QString &service, const QDBusConnection &connection, QObject *parent)
     : QObject(parent)
@@ -41,7 +44,21 @@ MprisController::MprisController(const QString &service, const QDBusConnection &
     , m_initedPlayerInterface(false)
     , m_requestedPosition(false)
     , m_canControlReceived(false)
-{
+    , m_repliedRootInterface(false)
+    , m_repliedPlayerInterface(false)
+    , m_positionBase(0)
+    , m_positionRate(1)
+    , m_positionPlaying(false)
+    , m_trackLength(-1)
+    , m_positionDriftTimer(new QTimer(this))
+    , m_pendingCommands(0)
+    , m_collapsedCommands(0)
+    , m_positionCommandInFlight(false)
+    , m_skipCommandInFlight(false)
+{
+    m_positionDriftTimer->setInterval(positionDriftCheckInterval);
+    connect(m_positionDriftTimer, &QTimer::timeout, this, &MprisController::requestPosition);
+
     // Mpris Root Interface
     connect(m_mprisRootInterface, &MprisRootInterface::asyncGetAllPropertiesFinished, this, &MprisController::onAsyncGetAllRootPropertiesFinished);
     connect(m_mprisRootInterface, &MprisRootInterface::canQuitChanged, this, &MprisController::canQuitChanged);
@@ -73,11 +90,19 @@ MprisController::MprisController(const QString &service, const QDBusConnection &
     connect(m_mprisPlayerInterface, &MprisPlayerInterface::rateChanged, this, &MprisController::rateChanged);
     connect(m_mprisPlayerInterface, &MprisPlayerInterface::shuffleChanged, this, &MprisController::shuffleChanged);
     connect(m_mprisPlayerInterface, &MprisPlayerInterface::volumeChanged, this, &MprisController::volumeChanged);
-    connect(m_mprisPlayerInterface, &MprisPlayerInterface::seeked, this, &MprisController::seeked);
+    connect(m_mprisPlayerInterface, &MprisPlayerInterface::seeked, this, &MprisController::onSeeked);
+    connect(m_mprisPlayerInterface, &MprisPlayerInterface::playbackStatusChanged, this, &MprisController::onPlaybackStatusChanged);
+    connect(m_mprisPlayerInterface, &MprisPlayerInterface::rateChanged, this, &MprisController::onRateChanged);
+    connect(m_mprisPlayerInterface, &MprisPlayerInterface::metadataChanged, this, &MprisController::onMetadataChanged);
+    connect(m_mprisPlayerInterface, &MprisPlayerInterface::asyncPropertyFinished, this, &MprisController::onAsyncPropertyFinished);
     m_mprisPlayerInterface->setUseCache(true);
 
     // This will initialize the properties, if needed
-    isValid();
+    if (!isValid() && (!m_mprisRootInterface->isValid() || !m_mprisPlayerInterface->isValid())) {
+        // No GetAll went out, nothing to wait for.
+        m_repliedRootInterface = true;
+        m_repliedPlayerInterface = true;
+    }
 }
 
 MprisController::~MprisController()
@@ -113,6 +138,11 @@ bool MprisController::isValid() const
     return m_initedRootInterface && m_initedPlayerInterface;
 }
 
+bool MprisController::isInitialized() const
+{
+    return m_repliedRootInterface && m_repliedPlayerInterface;
+}
+
 // Mpris2 Root Interface
 bool MprisController::quit()
 {
@@ -121,10 +151,7 @@ bool MprisController::quit()
         return false;
     }
 
-    QDBusPendingReply<> reply = m_mprisRootInterface->Quit();
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-    QObject::connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
-                     this, SLOT(onFinishedPendingCall(QDBusPendingCallWatcher*)));
+    sendCommand(m_mprisRootInterface, QStringLiteral("Quit"));
 
     return true;
 }
@@ -136,10 +163,7 @@ bool MprisController::raise()
         return false;
     }
 
-    QDBusPendingReply<> reply = m_mprisRootInterface->Raise();
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-    QObject::connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
-                     this, SLOT(onFinishedPendingCall(QDBusPendingCallWatcher*)));
+    sendCommand(m_mprisRootInterface, QStringLiteral("Raise"));
 
     return true;
 }
@@ -152,10 +176,7 @@ bool MprisController::next()
         return false;
     }
 
-    QDBusPendingReply<> reply = m_mprisPlayerInterface->Next();
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-    QObject::connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
-                     this, SLOT(onFinishedPendingCall(QDBusPendingCallWatcher*)));
+    queueSkipCommand(QStringLiteral("Next"));
 
     return true;
 }
@@ -188,10 +209,7 @@ bool MprisController::openUri(const QUrl &uri)
     mimeNames.prepend(mime.name());
     for (int i = 0; i < mimeNames.size(); i++) {
         if (m_mprisRootInterface->supportedMimeTypes().contains(mimeNames[i])) {
-            QDBusPendingReply<> reply = m_mprisPlayerInterface->OpenUri(uri.toString());
-            QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-            QObject::connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
-                             this, SLOT(onFinishedPendingCall(QDBusPendingCallWatcher*)));
+            sendCommand(m_mprisPlayerInterface, QStringLiteral("OpenUri"), QVariantList() << QVariant::fromValue(uri.toString()));
             return true;
         }
     }
@@ -207,10 +225,7 @@ bool MprisController::pause()
         return false;
     }
 
-    QDBusPendingReply<> reply = m_mprisPlayerInterface->Pause();
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-    QObject::connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
-                     this, SLOT(onFinishedPendingCall(QDBusPendingCallWatcher*)));
+    sendCommand(m_mprisPlayerInterface, QStringLiteral("Pause"));
 
     return true;
 }
@@ -222,10 +237,7 @@ bool MprisController::play()
         return false;
     }
 
-    QDBusPendingReply<> reply = m_mprisPlayerInterface->Play();
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-    QObject::connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
-                     this, SLOT(onFinishedPendingCall(QDBusPendingCallWatcher*)));
+    sendCommand(m_mprisPlayerInterface, QStringLiteral("Play"));
 
     return true;
 }
@@ -237,10 +249,7 @@ bool MprisController::playPause()
         return false;
     }
 
-    QDBusPendingReply<> reply = m_mprisPlayerInterface->PlayPause();
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-    QObject::connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
-                     this, SLOT(onFinishedPendingCall(QDBusPendingCallWatcher*)));
+    sendCommand(m_mprisPlayerInterface, QStringLiteral("PlayPause"));
 
     return true;
 }
@@ -252,10 +261,7 @@ bool MprisController::previous()
         return false;
     }
 
-    QDBusPendingReply<> reply = m_mprisPlayerInterface->Previous();
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-    QObject::connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
-                     this, SLOT(onFinishedPendingCall(QDBusPendingCallWatcher*)));
+    queueSkipCommand(QStringLiteral("Previous"));
 
     return true;
 }
@@ -267,10 +273,7 @@ bool MprisController::seek(qlonglong offset)
         return false;
     }
 
-    QDBusPendingReply<> reply = m_mprisPlayerInterface->Seek(offset);
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-    QObject::connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
-                     this, SLOT(onFinishedPendingCall(QDBusPendingCallWatcher*)));
+    queuePositionCommand(false, QString(), offset);
 
     return true;
 }
@@ -314,10 +317,7 @@ bool MprisController::setPosition(const QString &aTrackId, qlonglong position)
         }
     }
 
-    QDBusPendingReply<> reply = m_mprisPlayerInterface->SetPosition(trackId, position);
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-    QObject::connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
-                     this, SLOT(onFinishedPendingCall(QDBusPendingCallWatcher*)));
+    queuePositionCommand(true, trackId.path(), position);
 
     return true;
 }
@@ -329,10 +329,7 @@ bool MprisController::stop()
         return false;
     }
 
-    QDBusPendingReply<> reply = m_mprisPlayerInterface->Stop();
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
-    QObject::connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
-                     this, SLOT(onFinishedPendingCall(QDBusPendingCallWatcher*)));
+    sendCommand(m_mprisPlayerInterface, QStringLiteral("Stop"));
 
     return true;
 }
@@ -543,16 +540,29 @@ Mpris::PlaybackStatus MprisController::playbackStatus() const
 
 qlonglong MprisController::position() const
 {
-    if (isValid()) {
-        m_mprisPlayerInterface->setSync(true);
-        m_mprisPlayerInterface->setUseCache(false);
-        qlonglong result = m_mprisPlayerInterface->position();
-        m_mprisPlayerInterface->setUseCache(true);
-        m_mprisPlayerInterface->setSync(false);
-        return result;
+    if (!isValid()) {
+        return -1;
+    }
+
+    if (!m_positionClock.isValid()) {
+        // Nothing to extrapolate from yet
+        requestPosition();
+        return m_positionBase;
+    }
+
+    qlonglong result = m_positionBase;
+    if (m_positionPlaying) {
+        result += qlonglong(m_positionClock.nsecsElapsed() / 1000 * m_positionRate);
+    }
+
+    if (result < 0) {
+        result = 0;
+    }
+    if (m_trackLength > 0 && result > m_trackLength) {
+        result = m_trackLength;
     }
 
-    return -1;
+    return result;
 }
 
 void MprisController::requestPosition() const
@@ -627,6 +637,13 @@ void MprisController::setVolume(double volume)
 
 void MprisController::onAsyncGetAllRootPropertiesFinished()
 {
+    if (!m_repliedRootInterface) {
+        m_repliedRootInterface = true;
+        if (m_repliedPlayerInterface) {
+            Q_EMIT initializationFinished();
+        }
+    }
+
     if (m_mprisRootInterface->lastExtendedError().isValid()) {
         qWarning() << Q_FUNC_INFO
                    << "Error" << m_mprisRootInterface->lastExtendedError().name()
@@ -635,10 +652,20 @@ void MprisController::onAsyncGetAllRootPropertiesFinished()
     }
 
     m_initedRootInterface = true;
+    if (m_initedPlayerInterface) {
+        initializePositionClock();
+    }
 }
 
 void MprisController::onAsyncGetAllPlayerPropertiesFinished()
 {
+    if (!m_repliedPlayerInterface) {
+        m_repliedPlayerInterface = true;
+        if (m_repliedRootInterface) {
+            Q_EMIT initializationFinished();
+        }
+    }
+
     if (m_mprisPlayerInterface->lastExtendedError().isValid()) {
         qWarning() << Q_FUNC_INFO
                    << "Error" << m_mprisPlayerInterface->lastExtendedError().name()
@@ -647,6 +674,9 @@ void MprisController::onAsyncGetAllPlayerPropertiesFinished()
     }
 
     m_initedPlayerInterface = true;
+    if (m_initedRootInterface) {
+        initializePositionClock();
+    }
 }
 
 void MprisController::onCanControlChanged()
@@ -672,20 +702,235 @@ void MprisController::onCanControlChanged()
 void MprisController::onPositionChanged(qlonglong aPosition)
 {
     m_requestedPosition = false;
+    syncPosition(aPosition);
     Q_EMIT positionChanged(aPosition);
 }
 
+void MprisController::onAsyncPropertyFinished(const QString &propertyName)
+{
+    if (propertyName != positionProperty) {
+        return;
+    }
+
+    m_requestedPosition = false;
+
+    // positionChanged is only emitted by the interface when the value differs
+    // from the cached one, but the clock needs resyncing in any case.
+    if (!m_mprisPlayerInterface->lastExtendedError().isValid()) {
+        syncPosition(m_mprisPlayerInterface->position());
+    }
+}
+
+void MprisController::onPlaybackStatusChanged()
+{
+    rebasePosition();
+    m_positionPlaying = playbackStatus() == Mpris::Playing;
+    if (m_positionPlaying) {
+        m_positionDriftTimer->start();
+    } else {
+        m_positionDriftTimer->stop();
+    }
+    requestPosition();
+}
+
+void MprisController::onRateChanged()
+{
+    rebasePosition();
+    m_positionRate = rate();
+    requestPosition();
+}
+
+void MprisController::onMetadataChanged()
+{
+    const QVariantMap metadata = m_mprisPlayerInterface->metadata();
+    const QVariant length = metadata.value(Mpris::metadataToString(Mpris::Length));
+    const qlonglong trackLength = length.isValid() ? length.toLongLong() : -1;
+    const QString trackId = metadata.value(Mpris::metadataToString(Mpris::TrackId)).value<QDBusObjectPath>().path();
+
+    // Browsers resend Metadata several times a second for the same track,
+    // only an actual track change invalidates the local clock
+    if (trackId == m_trackId && trackLength == m_trackLength) {
+        return;
+    }
+
+    m_trackId = trackId;
+    m_trackLength = trackLength;
+    requestPosition();
+}
+
+void MprisController::initializePositionClock()
+{
+    // Status, rate and track read as defaults until both GetAll replies are
+    // in, so a player that was already playing would keep a frozen clock
+    onMetadataChanged();
+    onRateChanged();
+    onPlaybackStatusChanged();
+}
+
+void MprisController::onSeeked(qlonglong aPosition)
+{
+    syncPosition(aPosition);
+    Q_EMIT seeked(aPosition);
+    Q_EMIT positionChanged(aPosition);
+}
+
+void MprisController::syncPosition(qlonglong position)
+{
+    m_positionBase = position;
+    m_positionClock.start();
+}
+
+void MprisController::rebasePosition()
+{
+    if (!m_positionClock.isValid()) {
+        return;
+    }
+
+    syncPosition(position());
+}
+
 
 // Private
 
-void MprisController::onFinishedPendingCall(QDBusPendingCallWatcher *call)
+bool MprisController::sendCommand(QDBusAbstractInterface *interface, const QString &method, const QVariantList &arguments,
+                                  const char *returnMethod, const char *errorMethod)
 {
-    QDBusPendingReply<> reply = *call;
-    if (reply.isError()) {
-        qWarning() << Q_FUNC_INFO
-                   << "Error" << reply.error().name()
-                   << "happened:" << reply.error().message();
+    // Replies are delivered straight to the typed slots, no watcher object per call
+    if (!interface->callWithCallback(method, arguments, this, returnMethod, errorMethod)) {
+        qWarning() << Q_FUNC_INFO << "Failed sending" << method;
+        return false;
+    }
+
+    ++m_pendingCommands;
+    Q_EMIT pendingCommandsChanged();
+    return true;
+}
+
+void MprisController::queueSkipCommand(const QString &method)
+{
+    if (!m_skipCommandInFlight) {
+        sendSkipCommand(method);
+        return;
+    }
+
+    // Like absolute seeks, only the latest skip waits for the one in flight
+    if (!m_queuedSkipCommand.isEmpty()) {
+        ++m_collapsedCommands;
+        Q_EMIT collapsedCommandsChanged();
+    }
+    m_queuedSkipCommand = method;
+}
+
+void MprisController::sendSkipCommand(const QString &method)
+{
+    m_skipCommandInFlight = sendCommand(m_mprisPlayerInterface, method, QVariantList(),
+                                        SLOT(onSkipCommandFinished()), SLOT(onSkipCommandError(QDBusError)));
+}
+
+void MprisController::queuePositionCommand(bool absolute, const QString &trackId, qlonglong value)
+{
+    if (!m_positionCommandInFlight) {
+        sendPositionCommand(absolute, trackId, value);
+        return;
+    }
+
+    // Only the latest target matters while the player is still busy with
+    // the previous one. Relative seeks add up, absolute ones replace.
+    if (m_queuedPositionCommand.queued) {
+        ++m_collapsedCommands;
+        Q_EMIT collapsedCommandsChanged();
+        if (!absolute) {
+            m_queuedPositionCommand.value += value;
+            return;
+        }
+    }
+
+    m_queuedPositionCommand.queued = true;
+    m_queuedPositionCommand.absolute = absolute;
+    m_queuedPositionCommand.trackId = trackId;
+    m_queuedPositionCommand.value = value;
+}
+
+void MprisController::sendPositionCommand(bool absolute, const QString &trackId, qlonglong value)
+{
+    QVariantList arguments;
+    QString method;
+    if (absolute) {
+        method = QStringLiteral("SetPosition");
+        arguments << QVariant::fromValue(QDBusObjectPath(trackId)) << QVariant::fromValue(value);
+    } else {
+        method = QStringLiteral("Seek");
+        arguments << QVariant::fromValue(value);
     }
 
-    call->deleteLater();
+    m_positionCommandInFlight = sendCommand(m_mprisPlayerInterface, method, arguments,
+                                            SLOT(onPositionCommandFinished()), SLOT(onPositionCommandError(QDBusError)));
+}
+
+void MprisController::onCommandFinished()
+{
+    --m_pendingCommands;
+    Q_EMIT pendingCommandsChanged();
+}
+
+void MprisController::onCommandError(const QDBusError &error)
+{
+    qWarning() << Q_FUNC_INFO
+               << "Error" << error.name()
+               << "happened:" << error.message();
+
+    onCommandFinished();
+}
+
+void MprisController::onPositionCommandFinished()
+{
+    m_positionCommandInFlight = false;
+    onCommandFinished();
+
+    if (m_queuedPositionCommand.queued) {
+        m_queuedPositionCommand.queued = false;
+        sendPositionCommand(m_queuedPositionCommand.absolute,
+                            m_queuedPositionCommand.trackId,
+                            m_queuedPositionCommand.value);
+    }
+}
+
+void MprisController::onPositionCommandError(const QDBusError &error)
+{
+    qWarning() << Q_FUNC_INFO
+               << "Error" << error.name()
+               << "happened:" << error.message();
+
+    onPositionCommandFinished();
+}
+
+void MprisController::onSkipCommandFinished()
+{
+    m_skipCommandInFlight = false;
+    onCommandFinished();
+
+    if (!m_queuedSkipCommand.isEmpty()) {
+        const QString method = m_queuedSkipCommand;
+        m_queuedSkipCommand.clear();
+        sendSkipCommand(method);
+    }
+}
+
+void MprisController::onSkipCommandError(const QDBusError &error)
+{
+    qWarning() << Q_FUNC_INFO
+               << "Error" << error.name()
+               << "happened:" << error.message();
+
+    onSkipCommandFinished();
+}
+
+int MprisController::pendingCommands() const
+{
+    return m_pendingCommands;
+}
+
+int MprisController::collapsedCommands() const
+{
+    return m_collapsedCommands;
 }
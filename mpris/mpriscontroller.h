@@ -34,6 +34,7 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QList>
 #include <QtCore/QMap>
 #include <QtCore/QString>
@@ -43,13 +44,19 @@
 
 class MprisRootInterface;
 class MprisPlayerInterface;
-class QDBusPendingCallWatcher;
+class QDBusAbstractInterface;
+class QDBusError;
+class QTimer;
 class MPRIS_QT_EXPORT MprisController : public QObject
 {
     Q_OBJECT
 
     Q_PROPERTY(QString service READ service)
 
+    // Diagnostics
+    Q_PROPERTY(int pendingCommands READ pendingCommands NOTIFY pendingCommandsChanged)
+    Q_PROPERTY(int collapsedCommands READ collapsedCommands NOTIFY collapsedCommandsChanged)
+
     // Mpris2 Root Interface
     Q_PROPERTY(bool canQuit READ canQuit NOTIFY canQuitChanged)
     Q_PROPERTY(bool canRaise READ canRaise NOTIFY canRaiseChanged)
@@ -73,7 +80,7 @@ class MPRIS_QT_EXPORT MprisController : public QObject
     Q_PROPERTY(QVariantMap metadata READ metadata NOTIFY metadataChanged)
     Q_PROPERTY(double minimumRate READ minimumRate NOTIFY minimumRateChanged)
     Q_PROPERTY(Mpris::PlaybackStatus playbackStatus READ playbackStatus NOTIFY playbackStatusChanged)
-    Q_PROPERTY(qlonglong position READ position)
+    Q_PROPERTY(qlonglong position READ position NOTIFY positionChanged)
     Q_PROPERTY(double rate READ rate WRITE setRate NOTIFY rateChanged)
     Q_PROPERTY(bool shuffle READ shuffle WRITE setShuffle NOTIFY shuffleChanged)
     Q_PROPERTY(double volume READ volume WRITE setVolume NOTIFY volumeChanged)
@@ -85,6 +92,9 @@ public:
 
     bool isValid() const;
 
+    // True once both interfaces answered their initial GetAll, successfully or not
+    bool isInitialized() const;
+
     // Mpris2 Root Interface
     bool quit();
     bool raise();
@@ -105,6 +115,9 @@ public Q_SLOTS:
 
     QString service() const;
 
+    int pendingCommands() const;
+    int collapsedCommands() const;
+
     // Mpris2 Root Interface
     bool canQuit() const;
 
@@ -192,14 +205,39 @@ Q_SIGNALS:
     void volumeChanged();
     void seeked(qlonglong position);
 
+    void initializationFinished();
+    void pendingCommandsChanged();
+    void collapsedCommandsChanged();
+
 protected Q_SLOTS:
     void onAsyncGetAllRootPropertiesFinished();
     void onAsyncGetAllPlayerPropertiesFinished();
     void onCanControlChanged();
     void onPositionChanged(qlonglong aPosition);
-    void onFinishedPendingCall(QDBusPendingCallWatcher *call);
+    void onAsyncPropertyFinished(const QString &propertyName);
+    void onPlaybackStatusChanged();
+    void onRateChanged();
+    void onMetadataChanged();
+    void onSeeked(qlonglong aPosition);
+    void onCommandFinished();
+    void onCommandError(const QDBusError &error);
+    void onPositionCommandFinished();
+    void onPositionCommandError(const QDBusError &error);
+    void onSkipCommandFinished();
+    void onSkipCommandError(const QDBusError &error);
 
 private:
+    bool sendCommand(QDBusAbstractInterface *interface, const QString &method, const QVariantList &arguments = QVariantList(),
+                     const char *returnMethod = SLOT(onCommandFinished()), const char *errorMethod = SLOT(onCommandError(QDBusError)));
+    void queueSkipCommand(const QString &method);
+    void sendSkipCommand(const QString &method);
+    void queuePositionCommand(bool absolute, const QString &trackId, qlonglong value);
+    void sendPositionCommand(bool absolute, const QString &trackId, qlonglong value);
+
+    void initializePositionClock();
+    void syncPosition(qlonglong position);
+    void rebasePosition();
+
     MprisRootInterface *m_mprisRootInterface;
     MprisPlayerInterface *m_mprisPlayerInterface;
 
@@ -207,6 +245,34 @@ private:
     mutable bool m_initedPlayerInterface;
     mutable bool m_requestedPosition;
     bool m_canControlReceived;
+    bool m_repliedRootInterface;
+    bool m_repliedPlayerInterface;
+
+    // Local position clock. MPRIS doesn't signal position changes, so the
+    // last known position is extrapolated and only resynced on Seeked,
+    // playback status, rate or track changes and a slow drift check.
+    qlonglong m_positionBase;
+    QElapsedTimer m_positionClock;
+    double m_positionRate;
+    bool m_positionPlaying;
+    qlonglong m_trackLength;
+    QString m_trackId;
+    QTimer *m_positionDriftTimer;
+
+    // Seek/SetPosition waiting for the one in flight to finish
+    struct PositionCommand {
+        bool queued = false;
+        bool absolute = false;
+        QString trackId;
+        qlonglong value = 0;
+    };
+    int m_pendingCommands;
+    int m_collapsedCommands;
+    bool m_positionCommandInFlight;
+    PositionCommand m_queuedPositionCommand;
+    // Next/Previous waiting for the one in flight to finish
+    bool m_skipCommandInFlight;
+    QString m_queuedSkipCommand;
 };
 
 #endif /* MPRISCONTROLLER_H */
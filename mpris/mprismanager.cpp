@@ -31,14 +31,17 @@
 
 #include <QDBusConnection>
 #include <QDBusConnectionInterface>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
 
-#include <QtCore/QSignalMapper>
+static const QString mprisNameSpace = QStringLiteral("org.mpris.MediaPlayer2.");
+static const QString mprisWatchPattern = QStringLiteral("org.mpris.MediaPlayer2*");
 
-static const QString mprisNameSpace = QStringLiteral("org.mpris.MediaPlayer2.*");
-static const QString dBusService = QStringLiteral("org.freedesktop.DBus");
-static const QString dBusObjectPath = QStringLiteral("/org/freedesktop/DBus");
-static const QString dBusInterface = QStringLiteral("org.freedesktop.DBus");
-static const QString dBusNameOwnerChangedSignal = QStringLiteral("NameOwnerChanged");
+static inline bool isMprisService(const QString &service)
+{
+    return service.startsWith(mprisNameSpace) && service.length() > mprisNameSpace.length();
+}
 
 static inline QDBusConnection getDBusConnection()
 {
@@ -53,30 +56,34 @@ static inline QDBusConnection getDBusConnection()
 MprisManager::MprisManager(QObject *parent)
     : QObject(parent)
     , m_singleService(false)
-    , m_playbackStatusMapper(new QSignalMapper(this))
+    , m_players(new MprisPlayersModel(this))
+    , m_serviceWatcher(nullptr)
+    , m_listedNames(false)
+    , m_ready(false)
 {
+    connect(m_players, &MprisPlayersModel::playbackStatusChanged,
+            this, &MprisManager::onAvailableControllerPlaybackStatusChanged);
+
     QDBusConnection connection = getDBusConnection();
 
     if (!connection.isConnected()) {
         qmlInfo(this) << "Failed attempting to connect to DBus";
+        m_ready = true;
         return;
     }
 
-    connection.connect(dBusService, dBusObjectPath, dBusInterface, dBusNameOwnerChangedSignal,
-                       QStringList(), QString(),
-                       this, SLOT(onNameOwnerChanged(QString, QString, QString)));
-
-    QStringList serviceNames = connection.interface()->registeredServiceNames();
-    QStringList::const_iterator i = serviceNames.constBegin();
-    while (i != serviceNames.constEnd()) {
-        QRegExp rx(mprisNameSpace);
-        rx.setPatternSyntax(QRegExp::Wildcard);
-        if (rx.exactMatch(*i)) {
-            onServiceAppeared(*i);
-        }
+    // The wildcard makes the watcher install an "arg0namespace" match rule,
+    // so the bus daemon only sends us the name changes of Mpris2 services.
+    m_serviceWatcher = new QDBusServiceWatcher(mprisWatchPattern, connection,
+                                               QDBusServiceWatcher::WatchForOwnerChange, this);
+    connect(m_serviceWatcher, &QDBusServiceWatcher::serviceOwnerChanged,
+            this, &MprisManager::onNameOwnerChanged);
 
-        ++i;
-    }
+    // Don't block the instantiation on the bus, the initial set of
+    // players is reported once the daemon answers.
+    QDBusPendingCall async = connection.interface()->asyncCall(QStringLiteral("ListNames"));
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(async, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, &MprisManager::onListNamesFinished);
 }
 
 MprisManager::~MprisManager()
@@ -174,38 +181,42 @@ void MprisManager::setCurrentService(const QString &service)
         return;
     }
 
-    QRegExp rx(mprisNameSpace);
-    rx.setPatternSyntax(QRegExp::Wildcard);
-    if (!rx.exactMatch(service)) {
+    if (!isMprisService(service)) {
         qmlInfo(this) << service << "is not a proper Mpris2 service";
         return;
     }
 
-    QSharedPointer<MprisController> controller = availableController(service);
+    QSharedPointer<MprisController> controller = m_players->controller(service);
     if (controller.isNull()) {
         controller = QSharedPointer<MprisController>(new MprisController(service, getDBusConnection(), this));
-    } else {
-        m_availableControllers.move(m_availableControllers.indexOf(controller), 0);
     }
 
     setCurrentController(controller);
 }
 
-QStringList MprisManager::availableServices() const
+bool MprisManager::ready() const
 {
-    QStringList result;
+    return m_ready;
+}
 
-    QList< QSharedPointer<MprisController> >::const_iterator i = m_availableControllers.constBegin();
-    while (i != m_availableControllers.constEnd()) {
-        const QSharedPointer<MprisController> controller = *i;
-        result.append(controller->service());
+QStringList MprisManager::availableServices() const
+{
+    QStringList result = m_players->services();
 
-        ++i;
+    // The current service goes first
+    const int current = m_currentController.isNull() ? -1 : m_players->indexOf(m_currentController->service());
+    if (current > 0) {
+        result.move(current, 0);
     }
 
     return result;
 }
 
+MprisPlayersModel *MprisManager::players() const
+{
+    return m_players;
+}
+
 // Mpris2 Root Interface
 bool MprisManager::canQuit() const
 {
@@ -375,15 +386,9 @@ void MprisManager::setVolume(double volume)
 
 void MprisManager::onNameOwnerChanged(const QString &service, const QString &oldOwner, const QString &newOwner)
 {
-    // Unfortunately, QDBus doesn't allow flexible signal watchers.
-    // Would it allow them, we could pass the filter "arg0namespace='org.mpris.MediaPlayer2'"
-    // Therefore, we will receive here all the name changes in the
-    // bus, not just the ones for our name space of interest, and we
-    // will have to filter on our own :(
-
-    QRegExp rx(mprisNameSpace);
-    rx.setPatternSyntax(QRegExp::Wildcard);
-    if (!rx.exactMatch(service)) {
+    // The bus already filters on "arg0namespace='org.mpris.MediaPlayer2'",
+    // but that also matches the bare namespace name itself.
+    if (!isMprisService(service)) {
         return;
     }
 
@@ -400,44 +405,72 @@ void MprisManager::onNameOwnerChanged(const QString &service, const QString &old
     // Service changed owner. Nothing to do ...
 }
 
-void MprisManager::onServiceAppeared(const QString &service)
+void MprisManager::onListNamesFinished(QDBusPendingCallWatcher *call)
 {
-    QSharedPointer<MprisController> controller = availableController(service);
-    if (!controller.isNull()) {
-        Q_ASSERT(m_availableControllers.contains(controller));
-        m_availableControllers.removeOne(controller);
-        m_otherPlayingControllers.removeOne(controller);
+    QDBusPendingReply<QStringList> reply = *call;
+    call->deleteLater();
+
+    if (reply.isError()) {
+        qWarning() << Q_FUNC_INFO
+                   << "Error" << reply.error().name()
+                   << "happened:" << reply.error().message();
     } else {
+        // Every controller fires its GetAll calls right away, so all the
+        // players found here are queried in parallel.
+        const QStringList serviceNames = reply.value();
+        for (const QString &service : serviceNames) {
+            if (!isMprisService(service)) {
+                continue;
+            }
+
+            onServiceAppeared(service);
+
+            QSharedPointer<MprisController> controller = m_players->controller(service);
+            if (!controller.isNull() && !controller->isInitialized()) {
+                m_pendingServices.insert(service);
+                // Queued, the cached values are only filled in after the GetAll
+                // finished notification.
+                connect(controller.data(), &MprisController::initializationFinished, this, [this, service]() {
+                    m_pendingServices.remove(service);
+                    checkReady();
+                }, Qt::QueuedConnection);
+            }
+        }
+    }
+
+    m_listedNames = true;
+    checkReady();
+}
+
+void MprisManager::checkReady()
+{
+    if (m_ready || !m_listedNames || !m_pendingServices.isEmpty()) {
+        return;
+    }
+
+    m_ready = true;
+    Q_EMIT readyChanged();
+}
+
+void MprisManager::onServiceAppeared(const QString &service)
+{
+    QSharedPointer<MprisController> controller = m_players->controller(service);
+    if (controller.isNull()) {
         if (!m_currentController.isNull() && service == m_currentController->service()) {
             controller = m_currentController;
         } else {
             controller = QSharedPointer<MprisController>(new MprisController(service, getDBusConnection(), this));
         }
 
-        connect(controller.data(), SIGNAL(playbackStatusChanged()), m_playbackStatusMapper, SLOT(map()));
-        m_playbackStatusMapper->setMapping(controller.data(), controller->service());
-        connect(m_playbackStatusMapper, SIGNAL(mapped(QString)), this, SLOT(onAvailableControllerPlaybackStatusChanged(QString)));
+        m_players->addController(controller);
     }
 
     if (m_currentController.isNull()) {
         setCurrentController(controller);
-    }
-
-    if (controller == m_currentController) {
-        m_availableControllers.prepend(controller);
-        Q_EMIT availableServicesChanged();
-        return;
-    }
-
-    if (!m_singleService
-        && m_currentController->playbackStatus() != Mpris::Playing) {
-        m_availableControllers.prepend(controller);
+    } else if (controller != m_currentController
+               && !m_singleService
+               && m_currentController->playbackStatus() != Mpris::Playing) {
         setCurrentController(controller);
-    } else {
-        m_availableControllers.insert(1, controller);
-        if (controller->playbackStatus() == Mpris::Playing) {
-            m_otherPlayingControllers.prepend(controller);
-        }
     }
 
     Q_EMIT availableServicesChanged();
@@ -445,74 +478,56 @@ void MprisManager::onServiceAppeared(const QString &service)
 
 void MprisManager::onServiceVanished(const QString &service)
 {
-    QSharedPointer<MprisController> controller = availableController(service);
-    if (!controller.isNull()) {
-        Q_ASSERT(m_availableControllers.contains(controller));
-        m_availableControllers.removeOne(controller);
-        m_otherPlayingControllers.removeOne(controller);
+    if (m_pendingServices.remove(service)) {
+        checkReady();
     }
 
+    m_players->removeController(service);
+
     if (!m_currentController.isNull() && service == m_currentController->service()) {
         if (m_singleService) {
             Q_EMIT availableServicesChanged();
             return;
         }
 
-        if (!m_availableControllers.isEmpty()) {
-            setCurrentController(m_availableControllers[0]);
-        } else {
-            setCurrentController(QSharedPointer<MprisController>());
+        QSharedPointer<MprisController> controller = m_players->lastPlaying();
+        if (controller.isNull()) {
+            controller = m_players->controllerAt(0);
         }
+        setCurrentController(controller);
     }
 
     Q_EMIT availableServicesChanged();
 }
 
-void MprisManager::onAvailableControllerPlaybackStatusChanged(const QString &service)
+void MprisManager::onAvailableControllerPlaybackStatusChanged(const QSharedPointer<MprisController> &controller)
 {
-    QSharedPointer<MprisController> controller = availableController(service);
-    Q_ASSERT(!controller.isNull());
+    if (m_currentController.isNull()) {
+        return;
+    }
 
     if (m_currentController == controller) {
         if (m_currentController->playbackStatus() == Mpris::Playing) {
             return;
         }
 
-        if (!m_otherPlayingControllers.isEmpty()) {
-            QSharedPointer<MprisController> currentController = m_otherPlayingControllers.takeFirst();
-            m_availableControllers.move(m_availableControllers.indexOf(currentController), 0);
+        // The model keeps the playing players in order, no list juggling here
+        QSharedPointer<MprisController> currentController = m_players->lastPlaying(m_currentController);
+        if (!currentController.isNull()) {
             setCurrentController(currentController);
+            Q_EMIT availableServicesChanged();
         }
     } else {
         if (controller->playbackStatus() != Mpris::Playing) {
-            m_otherPlayingControllers.removeOne(controller);
             return;
         }
 
         if (!m_singleService
             && m_currentController->playbackStatus() != Mpris::Playing) {
             setCurrentController(controller);
-        } else {
-            m_availableControllers.move(m_availableControllers.indexOf(controller), 1);
-            m_otherPlayingControllers.removeOne(controller); // Just in case, shouldn't be needed
-            m_otherPlayingControllers.prepend(controller);
-        }
-    }
-}
-
-QSharedPointer<MprisController> MprisManager::availableController(const QString &service)
-{
-    QList< QSharedPointer<MprisController> >::iterator i = m_availableControllers.begin();
-    while (i != m_availableControllers.end()) {
-        QSharedPointer<MprisController> controller = *i;
-        if (!controller.isNull() && controller->service() == service) {
-            return controller;
+            Q_EMIT availableServicesChanged();
         }
-
-        ++i;
     }
-
-    return QSharedPointer<MprisController>();
 }
 
 void MprisManager::setCurrentController(QSharedPointer<MprisController> controller)
@@ -550,10 +565,6 @@ void MprisManager::setCurrentController(QSharedPointer<MprisController> controll
         disconnect(m_currentController.data(), &MprisController::shuffleChanged, this, &MprisManager::shuffleChanged);
         disconnect(m_currentController.data(), &MprisController::volumeChanged, this, &MprisManager::volumeChanged);
         disconnect(m_currentController.data(), &MprisController::seeked, this, &MprisManager::seeked);
-
-        if (m_currentController->playbackStatus() == Mpris::Playing) {
-            m_otherPlayingControllers.prepend(m_currentController);
-        }
     }
 
     m_currentController = controller;
@@ -582,16 +593,15 @@ void MprisManager::setCurrentController(QSharedPointer<MprisController> controll
         connect(m_currentController.data(), &MprisController::metadataChanged, this, &MprisManager::metadataChanged);
         connect(m_currentController.data(), &MprisController::minimumRateChanged, this, &MprisManager::minimumRateChanged);
         connect(m_currentController.data(), &MprisController::playbackStatusChanged, this, &MprisManager::playbackStatusChanged);
+        connect(m_currentController.data(), &MprisController::positionChanged, this, &MprisManager::positionChanged);
         connect(m_currentController.data(), &MprisController::rateChanged, this, &MprisManager::rateChanged);
         connect(m_currentController.data(), &MprisController::shuffleChanged, this, &MprisManager::shuffleChanged);
         connect(m_currentController.data(), &MprisController::volumeChanged, this, &MprisManager::volumeChanged);
         connect(m_currentController.data(), &MprisController::seeked, this, &MprisManager::seeked);
-
-        if (m_currentController->playbackStatus() == Mpris::Playing) {
-            m_otherPlayingControllers.removeOne(m_currentController);
-        }
     }
 
+    m_players->setCurrentService(currentService());
+
     Q_EMIT currentServiceChanged();
 }
 
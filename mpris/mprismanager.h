@@ -29,6 +29,7 @@
 #include "mprisqt.h"
 #include "mpris.h"
 #include "mpriscontroller.h"
+#include "mprisplayersmodel.h"
 
 #include <QDBusConnection>
 #include <QDBusObjectPath>
@@ -37,12 +38,14 @@
 #include <QtCore/QList>
 #include <QtCore/QMap>
 #include <QtCore/QObject>
+#include <QtCore/QSet>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 #include <QtCore/QVariant>
 
-class QSignalMapper;
+class QDBusPendingCallWatcher;
+class QDBusServiceWatcher;
 class MPRIS_QT_EXPORT MprisManager : public QObject
 {
     Q_OBJECT
@@ -50,6 +53,8 @@ class MPRIS_QT_EXPORT MprisManager : public QObject
     Q_PROPERTY(bool singleService READ singleService WRITE setSingleService NOTIFY singleServiceChanged)
     Q_PROPERTY(QString currentService READ currentService WRITE setCurrentService NOTIFY currentServiceChanged)
     Q_PROPERTY(QStringList availableServices READ availableServices NOTIFY availableServicesChanged)
+    Q_PROPERTY(bool ready READ ready NOTIFY readyChanged)
+    Q_PROPERTY(MprisPlayersModel *players READ players CONSTANT)
 
     // Mpris2 Root Interface
     Q_PROPERTY(bool canQuit READ canQuit NOTIFY canQuitChanged)
@@ -74,7 +79,7 @@ class MPRIS_QT_EXPORT MprisManager : public QObject
     Q_PROPERTY(QVariantMap metadata READ metadata NOTIFY metadataChanged)
     Q_PROPERTY(double minimumRate READ minimumRate NOTIFY minimumRateChanged)
     Q_PROPERTY(Mpris::PlaybackStatus playbackStatus READ playbackStatus NOTIFY playbackStatusChanged)
-    Q_PROPERTY(qlonglong position READ position)
+    Q_PROPERTY(qlonglong position READ position NOTIFY positionChanged)
     Q_PROPERTY(double rate READ rate WRITE setRate NOTIFY rateChanged)
     Q_PROPERTY(bool shuffle READ shuffle WRITE setShuffle NOTIFY shuffleChanged)
     Q_PROPERTY(double volume READ volume WRITE setVolume NOTIFY volumeChanged)
@@ -110,6 +115,10 @@ public Q_SLOTS:
 
     QStringList availableServices() const;
 
+    bool ready() const;
+
+    MprisPlayersModel *players() const;
+
     // Mpris2 Root Interface
     bool canQuit() const;
 
@@ -170,6 +179,7 @@ Q_SIGNALS:
     void singleServiceChanged();
     void currentServiceChanged();
     void availableServicesChanged();
+    void readyChanged();
 
     // Mpris2 Root Interface
     void canQuitChanged();
@@ -201,21 +211,24 @@ Q_SIGNALS:
     void seeked(qlonglong position);
 
 private Q_SLOTS:
+    void onListNamesFinished(QDBusPendingCallWatcher *call);
     void onNameOwnerChanged(const QString &service, const QString &oldOwner, const QString& newOwner);
     void onServiceAppeared(const QString &service);
     void onServiceVanished(const QString &service);
-    void onAvailableControllerPlaybackStatusChanged(const QString &service);
+    void onAvailableControllerPlaybackStatusChanged(const QSharedPointer<MprisController> &controller);
 
 private:
-    QSharedPointer<MprisController> availableController(const QString &service);
     void setCurrentController(QSharedPointer<MprisController> controller);
     bool checkController(const char *callerName) const;
+    void checkReady();
 
     bool m_singleService;
     QSharedPointer<MprisController> m_currentController;
-    QList< QSharedPointer<MprisController> > m_availableControllers;
-    QList< QSharedPointer<MprisController> > m_otherPlayingControllers;
-    QSignalMapper *m_playbackStatusMapper;
+    MprisPlayersModel *m_players;
+    QDBusServiceWatcher *m_serviceWatcher;
+    QSet<QString> m_pendingServices;
+    bool m_listedNames;
+    bool m_ready;
 };
 
 #endif /* MPRISMANAGER_H */
@@ -35,6 +35,8 @@
 #include <QDBusPendingCallWatcher>
 #include <QDBusReply>
 
+#include <QtCore/QTimer>
+
 static const QString serviceNamePrefix = QStringLiteral("org.mpris.MediaPlayer2.");
 static const QString mprisObjectPath = QStringLiteral("/org/mpris/MediaPlayer2");
 static const QString dBusPropertiesInterface = QStringLiteral("org.freedesktop.DBus.Properties");
@@ -74,6 +76,7 @@ MprisPlayer::MprisPlayer(QObject *parent)
     , m_rate(1)
     , m_shuffle(false)
     , m_volume(0)
+    , m_propertiesChangedScheduled(false)
 {
     QDBusConnection connection = getDBusConnection();
 
@@ -563,12 +566,51 @@ void MprisPlayer::unregisterService()
     }
 }
 
-void MprisPlayer::notifyPropertiesChanged(const QString& interfaceName, const QVariantMap &changedProperties, const QStringList &invalidatedProperties) const
+void MprisPlayer::notifyPropertiesChanged(const QString& interfaceName, const QVariantMap &changedProperties, const QStringList &invalidatedProperties)
 {
     if (m_serviceName.isEmpty()) {
         return;
     }
 
+    QVariantMap &pendingChanged = m_pendingChangedProperties[interfaceName];
+    QStringList &pendingInvalidated = m_pendingInvalidatedProperties[interfaceName];
+
+    // The latest value wins
+    QVariantMap::const_iterator i = changedProperties.constBegin();
+    while (i != changedProperties.constEnd()) {
+        pendingChanged.insert(i.key(), i.value());
+        pendingInvalidated.removeAll(i.key());
+        ++i;
+    }
+
+    QStringList::const_iterator j = invalidatedProperties.constBegin();
+    while (j != invalidatedProperties.constEnd()) {
+        pendingChanged.remove(*j);
+        if (!pendingInvalidated.contains(*j)) {
+            pendingInvalidated.append(*j);
+        }
+        ++j;
+    }
+
+    if (!m_propertiesChangedScheduled) {
+        m_propertiesChangedScheduled = true;
+        QTimer::singleShot(0, this, &MprisPlayer::flushPropertiesChanged);
+    }
+}
+
+void MprisPlayer::flushPropertiesChanged()
+{
+    m_propertiesChangedScheduled = false;
+
+    const QMap<QString, QVariantMap> changed = m_pendingChangedProperties;
+    const QMap<QString, QStringList> invalidated = m_pendingInvalidatedProperties;
+    m_pendingChangedProperties.clear();
+    m_pendingInvalidatedProperties.clear();
+
+    if (m_serviceName.isEmpty()) {
+        return;
+    }
+
     QDBusConnection connection = getDBusConnection();
 
     if (!connection.isConnected()) {
@@ -576,15 +618,27 @@ void MprisPlayer::notifyPropertiesChanged(const QString& interfaceName, const QV
         return;
     }
 
-    QDBusMessage message = QDBusMessage::createSignal(mprisObjectPath,
-                                                      dBusPropertiesInterface,
-                                                      dBusPropertiesChangedSignal);
+    QMap<QString, QVariantMap>::const_iterator i = changed.constBegin();
+    while (i != changed.constEnd()) {
+        const QString &interfaceName = i.key();
+        const QVariantMap &changedProperties = i.value();
+        const QStringList invalidatedProperties = invalidated.value(interfaceName);
+        ++i;
+
+        if (changedProperties.isEmpty() && invalidatedProperties.isEmpty()) {
+            continue;
+        }
 
-    QList<QVariant> arguments;
-    arguments << QVariant(interfaceName) << QVariant(changedProperties) << QVariant(invalidatedProperties);
-    message.setArguments(arguments);
+        QDBusMessage message = QDBusMessage::createSignal(mprisObjectPath,
+                                                          dBusPropertiesInterface,
+                                                          dBusPropertiesChangedSignal);
 
-    if (!connection.send(message)) {
-        qmlInfo(this) << "Failed to send DBus property notification signal";
+        QList<QVariant> arguments;
+        arguments << QVariant(interfaceName) << QVariant(changedProperties) << QVariant(invalidatedProperties);
+        message.setArguments(arguments);
+
+        if (!connection.send(message)) {
+            qmlInfo(this) << "Failed to send DBus property notification signal";
+        }
     }
 }
@@ -207,7 +207,8 @@ private:
 
     void registerService();
     void unregisterService();
-    void notifyPropertiesChanged(const QString& interfaceName, const QVariantMap &changedProperties, const QStringList &invalidatedProperties) const;
+    void notifyPropertiesChanged(const QString& interfaceName, const QVariantMap &changedProperties, const QStringList &invalidatedProperties);
+    void flushPropertiesChanged();
 
     MprisRootAdaptor *m_mprisRootAdaptor;
     MprisPlayerAdaptor *m_mprisPlayerAdaptor;
@@ -243,6 +244,12 @@ private:
     bool m_shuffle;
     double m_volume;
 
+    // Property changes are accumulated per interface and sent as a single
+    // PropertiesChanged signal once control returns to the event loop.
+    QMap<QString, QVariantMap> m_pendingChangedProperties;
+    QMap<QString, QStringList> m_pendingInvalidatedProperties;
+    bool m_propertiesChangedScheduled;
+
     friend class MprisRootAdaptor;
     friend class MprisPlayerAdaptor;
 };
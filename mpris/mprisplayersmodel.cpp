@@ -0,0 +1,269 @@
+// -*- c++ -*-
+
+/*!
+ *
+ * Copyright (C) 2015 Jolla Ltd.
+ *
+ * Contact: Valerio Valerio <valerio.valerio@jolla.com>
+ * Author: Andres Gomez <andres.gomez@jolla.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+#include "mprisplayersmodel.h"
+
+static const QHash<int, QByteArray> playersRoleNames = {
+    { MprisPlayersModel::ServiceRole, "service" },
+    { MprisPlayersModel::IdentityRole, "identity" },
+    { MprisPlayersModel::DesktopEntryRole, "desktopEntry" },
+    { MprisPlayersModel::PlaybackStatusRole, "playbackStatus" },
+    { MprisPlayersModel::MetadataRole, "metadata" },
+    { MprisPlayersModel::TitleRole, "title" },
+    { MprisPlayersModel::ArtistRole, "artist" },
+    { MprisPlayersModel::AlbumRole, "album" },
+    { MprisPlayersModel::ArtUrlRole, "artUrl" },
+    { MprisPlayersModel::ArtImageRole, "artImage" },
+    { MprisPlayersModel::LengthRole, "length" },
+    { MprisPlayersModel::CanControlRole, "canControl" },
+    { MprisPlayersModel::CurrentRole, "current" }
+};
+
+
+MprisPlayersModel::MprisPlayersModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_playingSerial(0)
+{
+}
+
+MprisPlayersModel::~MprisPlayersModel()
+{
+}
+
+int MprisPlayersModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_players.count();
+}
+
+QVariant MprisPlayersModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_players.count()) {
+        return QVariant();
+    }
+
+    const QSharedPointer<MprisController> &controller = m_players.at(index.row()).controller;
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case IdentityRole:
+        return controller->identity();
+    case ServiceRole:
+        return controller->service();
+    case DesktopEntryRole:
+        return controller->desktopEntry();
+    case PlaybackStatusRole:
+        return controller->playbackStatus();
+    case MetadataRole:
+        return controller->metadata();
+    case TitleRole:
+        return controller->metadata().value(Mpris::metadataToString(Mpris::Title));
+    case ArtistRole:
+        return controller->metadata().value(Mpris::metadataToString(Mpris::Artist));
+    case AlbumRole:
+        return controller->metadata().value(Mpris::metadataToString(Mpris::Album));
+    case ArtUrlRole:
+        return controller->metadata().value(Mpris::metadataToString(Mpris::ArtUrl));
+    case ArtImageRole:
+        return Mpris::artImageSource(controller->metadata().value(Mpris::metadataToString(Mpris::ArtUrl)).toString());
+    case LengthRole:
+        return controller->metadata().value(Mpris::metadataToString(Mpris::Length));
+    case CanControlRole:
+        return controller->canControl();
+    case CurrentRole:
+        return controller->service() == m_currentService;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> MprisPlayersModel::roleNames() const
+{
+    return playersRoleNames;
+}
+
+int MprisPlayersModel::indexOf(const QString &service) const
+{
+    return m_rows.value(service, -1);
+}
+
+QSharedPointer<MprisController> MprisPlayersModel::controller(const QString &service) const
+{
+    const int row = indexOf(service);
+    return row < 0 ? QSharedPointer<MprisController>() : m_players.at(row).controller;
+}
+
+QSharedPointer<MprisController> MprisPlayersModel::controllerAt(int row) const
+{
+    return row < 0 || row >= m_players.count() ? QSharedPointer<MprisController>() : m_players.at(row).controller;
+}
+
+QStringList MprisPlayersModel::services() const
+{
+    QStringList result;
+    result.reserve(m_players.count());
+
+    for (const Player &player : m_players) {
+        result.append(player.controller->service());
+    }
+
+    return result;
+}
+
+void MprisPlayersModel::addController(const QSharedPointer<MprisController> &controller)
+{
+    if (controller.isNull() || m_rows.contains(controller->service())) {
+        return;
+    }
+
+    const int row = m_players.count();
+    MprisController *c = controller.data();
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_players.append(Player { controller, 0 });
+    m_rows.insert(c->service(), row);
+    endInsertRows();
+
+    // Each row only listens to its own controller, so an update costs a
+    // hash lookup and a dataChanged for the roles actually affected.
+    connect(c, &MprisController::playbackStatusChanged, this, [this, c]() {
+        onPlaybackStatusChanged(c);
+    });
+    connect(c, &MprisController::metadataChanged, this, [this, c]() {
+        emitRowChanged(c, { MetadataRole, TitleRole, ArtistRole, AlbumRole, ArtUrlRole, ArtImageRole, LengthRole });
+    });
+    connect(c, &MprisController::identityChanged, this, [this, c]() {
+        emitRowChanged(c, { Qt::DisplayRole, IdentityRole });
+    });
+    connect(c, &MprisController::desktopEntryChanged, this, [this, c]() {
+        emitRowChanged(c, { DesktopEntryRole });
+    });
+    connect(c, &MprisController::canControlChanged, this, [this, c]() {
+        emitRowChanged(c, { CanControlRole });
+    });
+
+    if (c->playbackStatus() == Mpris::Playing) {
+        m_players[row].playingSerial = ++m_playingSerial;
+        m_playing.insert(m_playingSerial, c);
+    }
+
+    Q_EMIT countChanged();
+}
+
+void MprisPlayersModel::removeController(const QString &service)
+{
+    const int row = indexOf(service);
+    if (row < 0) {
+        return;
+    }
+
+    const Player player = m_players.at(row);
+    disconnect(player.controller.data(), nullptr, this, nullptr);
+    if (player.playingSerial) {
+        m_playing.remove(player.playingSerial);
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_players.remove(row);
+    m_rows.remove(service);
+    for (int i = row; i < m_players.count(); ++i) {
+        m_rows[m_players.at(i).controller->service()] = i;
+    }
+    endRemoveRows();
+
+    Q_EMIT countChanged();
+}
+
+QSharedPointer<MprisController> MprisPlayersModel::lastPlaying(const QSharedPointer<MprisController> &except) const
+{
+    auto i = m_playing.constEnd();
+    while (i != m_playing.constBegin()) {
+        --i;
+        if (i.value() != except.data()) {
+            return controller(i.value()->service());
+        }
+    }
+
+    return QSharedPointer<MprisController>();
+}
+
+QString MprisPlayersModel::currentService() const
+{
+    return m_currentService;
+}
+
+void MprisPlayersModel::setCurrentService(const QString &service)
+{
+    if (m_currentService == service) {
+        return;
+    }
+
+    const int previousRow = indexOf(m_currentService);
+    m_currentService = service;
+    const int row = indexOf(m_currentService);
+
+    const QVector<int> roles = { CurrentRole };
+    if (previousRow >= 0) {
+        Q_EMIT dataChanged(index(previousRow), index(previousRow), roles);
+    }
+    if (row >= 0) {
+        Q_EMIT dataChanged(index(row), index(row), roles);
+    }
+
+    Q_EMIT currentServiceChanged();
+}
+
+
+// Private
+
+void MprisPlayersModel::onPlaybackStatusChanged(MprisController *controller)
+{
+    const int row = indexOf(controller->service());
+    if (row < 0) {
+        return;
+    }
+
+    Player &player = m_players[row];
+    const bool playing = controller->playbackStatus() == Mpris::Playing;
+    if (playing && !player.playingSerial) {
+        player.playingSerial = ++m_playingSerial;
+        m_playing.insert(player.playingSerial, controller);
+    } else if (!playing && player.playingSerial) {
+        m_playing.remove(player.playingSerial);
+        player.playingSerial = 0;
+    }
+
+    const QSharedPointer<MprisController> shared = player.controller;
+    Q_EMIT dataChanged(index(row), index(row), { PlaybackStatusRole });
+    Q_EMIT playbackStatusChanged(shared);
+}
+
+void MprisPlayersModel::emitRowChanged(MprisController *controller, const QVector<int> &roles)
+{
+    const int row = indexOf(controller->service());
+    if (row >= 0) {
+        Q_EMIT dataChanged(index(row), index(row), roles);
+    }
+}
@@ -0,0 +1,112 @@
+// -*- c++ -*-
+
+/*!
+ *
+ * Copyright (C) 2015 Jolla Ltd.
+ *
+ * Contact: Valerio Valerio <valerio.valerio@jolla.com>
+ * Author: Andres Gomez <andres.gomez@jolla.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+#ifndef MPRISPLAYERSMODEL_H
+#define MPRISPLAYERSMODEL_H
+
+#include "mprisqt.h"
+#include "mpris.h"
+#include "mpriscontroller.h"
+
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+class MPRIS_QT_EXPORT MprisPlayersModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(QString currentService READ currentService NOTIFY currentServiceChanged)
+
+public:
+
+    enum Roles {
+        ServiceRole = Qt::UserRole + 1,
+        IdentityRole,
+        DesktopEntryRole,
+        PlaybackStatusRole,
+        MetadataRole,
+        TitleRole,
+        ArtistRole,
+        AlbumRole,
+        ArtUrlRole,
+        ArtImageRole,
+        LengthRole,
+        CanControlRole,
+        CurrentRole
+    };
+
+    MprisPlayersModel(QObject *parent = 0);
+    ~MprisPlayersModel();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    Q_INVOKABLE int indexOf(const QString &service) const;
+
+    QSharedPointer<MprisController> controller(const QString &service) const;
+    QSharedPointer<MprisController> controllerAt(int row) const;
+    QStringList services() const;
+
+    void addController(const QSharedPointer<MprisController> &controller);
+    void removeController(const QString &service);
+
+    // The player that most recently started playing and still is, if any
+    QSharedPointer<MprisController> lastPlaying(const QSharedPointer<MprisController> &except = QSharedPointer<MprisController>()) const;
+
+    QString currentService() const;
+    void setCurrentService(const QString &service);
+
+Q_SIGNALS:
+    void countChanged();
+    void currentServiceChanged();
+    void playbackStatusChanged(const QSharedPointer<MprisController> &controller);
+
+private:
+    struct Player {
+        QSharedPointer<MprisController> controller;
+        // Key in m_playing while the player is playing, 0 otherwise
+        quint64 playingSerial;
+    };
+
+    void onPlaybackStatusChanged(MprisController *controller);
+    void emitRowChanged(MprisController *controller, const QVector<int> &roles);
+
+    QVector<Player> m_players;
+    QHash<QString, int> m_rows;
+    // Playing players ordered by the moment they started playing
+    QMap<quint64, MprisController *> m_playing;
+    quint64 m_playingSerial;
+    QString m_currentService;
+};
+
+#endif /* MPRISPLAYERSMODEL_H */
@@ -4,6 +4,8 @@
 #include "mpris.h"
 #include "mprisplayer.h"
 #include "mprismanager.h"
+#include "mprisplayersmodel.h"
+#include "mprisartprovider.h"
 
 class QmlPlugins : public QQmlExtensionPlugin
 {
@@ -15,6 +17,12 @@ public:
         qmlRegisterSingletonType<Mpris>(uri, 1, 0, "Mpris", Mpris::api_factory);
         qmlRegisterType<MprisPlayer>(uri, 1, 0, "MprisPlayer");
         qmlRegisterType<MprisManager>(uri, 1, 0, "MprisManager");
+        qmlRegisterUncreatableType<MprisPlayersModel>(uri, 1, 0, "MprisPlayersModel", QStringLiteral("Use MprisManager.players"));
+    }
+
+    void initializeEngine(QQmlEngine *engine, const char *uri) override {
+        Q_UNUSED(uri)
+        engine->addImageProvider(MprisArtProvider::providerId, new MprisArtProvider);
     }
 };
 
@@ -35,6 +35,7 @@
 
 #include <QtCore/QDebug>
 #include <QtCore/QMetaProperty>
+#include <QtCore/QMutex>
 
 
 Q_GLOBAL_STATIC_WITH_ARGS(QByteArray, dBusPropertiesInterface, ("org.freedesktop.DBus.Properties"))
@@ -49,6 +50,7 @@ DBusExtendedAbstractInterface::DBusExtendedAbstractInterface(const QString &serv
     , m_useCache(false)
     , m_getAllPendingCallWatcher(0)
     , m_propertiesChangedConnected(false)
+    , m_propertyTable(0)
 {
 }
 
@@ -56,6 +58,59 @@ DBusExtendedAbstractInterface::~DBusExtendedAbstractInterface()
 {
 }
 
+const DBusExtendedAbstractInterface::PropertyTable *DBusExtendedAbstractInterface::propertyTable() const
+{
+    if (m_propertyTable) {
+        return m_propertyTable;
+    }
+
+    // The generated proxies never change at runtime, so the table for each
+    // of them is built on first use and kept for the lifetime of the process.
+    static QMutex mutex;
+    static QHash<const QMetaObject *, PropertyTable *> tables;
+
+    const QMetaObject *mo = metaObject();
+
+    QMutexLocker locker(&mutex);
+    PropertyTable *table = tables.value(mo);
+    if (!table) {
+        table = new PropertyTable;
+        table->entries.reserve(mo->propertyCount());
+        for (int i = 0; i < mo->propertyCount(); ++i) {
+            PropertyEntry entry;
+            entry.metaProperty = mo->property(i);
+            entry.userType = entry.metaProperty.userType();
+            if (entry.userType != QMetaType::QVariant) {
+                entry.signature = QDBusMetaType::typeToSignature(entry.userType);
+            }
+
+            const QByteArray name(entry.metaProperty.name());
+            table->byName.insert(QString::fromLatin1(name), table->entries.size());
+            table->byLatin1Name.insert(name, table->entries.size());
+            table->entries.append(entry);
+        }
+        tables.insert(mo, table);
+    }
+
+    m_propertyTable = table;
+    return m_propertyTable;
+}
+
+const DBusExtendedAbstractInterface::PropertyEntry *DBusExtendedAbstractInterface::propertyEntry(const QString &propertyName) const
+{
+    const PropertyTable *table = propertyTable();
+    QHash<QString, int>::const_iterator i = table->byName.constFind(propertyName);
+    return i == table->byName.constEnd() ? 0 : &table->entries.at(i.value());
+}
+
+const DBusExtendedAbstractInterface::PropertyEntry *DBusExtendedAbstractInterface::propertyEntry(const char *propertyName) const
+{
+    const PropertyTable *table = propertyTable();
+    // Wrapping the name avoids a copy for the lookup
+    QHash<QByteArray, int>::const_iterator i = table->byLatin1Name.constFind(QByteArray::fromRawData(propertyName, qstrlen(propertyName)));
+    return i == table->byLatin1Name.constEnd() ? 0 : &table->entries.at(i.value());
+}
+
 void DBusExtendedAbstractInterface::getAllProperties()
 {
     m_lastExtendedError = QDBusError();
@@ -150,10 +205,10 @@ QVariant DBusExtendedAbstractInterface::internalPropGet(const char *propname, vo
 {
     m_lastExtendedError = QDBusError();
 
+    const PropertyEntry *entry = propertyEntry(propname);
+
     if (m_useCache) {
-        int propertyIndex = metaObject()->indexOfProperty(propname);
-        QMetaProperty metaProperty = metaObject()->property(propertyIndex);
-        return QVariant(metaProperty.type(), propertyPtr);
+        return entry ? QVariant(entry->userType, propertyPtr) : QVariant();
     }
 
     if (m_sync) {
@@ -166,9 +221,7 @@ QVariant DBusExtendedAbstractInterface::internalPropGet(const char *propname, vo
             return QVariant();
         }
 
-        int propertyIndex = metaObject()->indexOfProperty(propname);
-
-        if (-1 == propertyIndex) {
+        if (!entry) {
             QString errorMessage = QStringLiteral("Got unknown property \"%1\" to read")
                 .arg(QString::fromLatin1(propname));
             m_lastExtendedError = QDBusMessage::createError(QDBusError::Failed, errorMessage);
@@ -176,7 +229,7 @@ QVariant DBusExtendedAbstractInterface::internalPropGet(const char *propname, vo
             return QVariant();
         }
 
-        QMetaProperty metaProperty = metaObject()->property(propertyIndex);
+        const QMetaProperty &metaProperty = entry->metaProperty;
 
         if (!metaProperty.isReadable()) {
             QString errorMessage = QStringLiteral("Property \"%1\" is NOT readable")
@@ -187,10 +240,8 @@ QVariant DBusExtendedAbstractInterface::internalPropGet(const char *propname, vo
         }
 
         // is this metatype registered?
-        const char *expectedSignature = "";
-        if (int(metaProperty.type()) != QMetaType::QVariant) {
-            expectedSignature = QDBusMetaType::typeToSignature(metaProperty.userType());
-            if (0 == expectedSignature) {
+        if (entry->userType != QMetaType::QVariant) {
+            if (entry->signature.isNull()) {
                 QString errorMessage =
                     QStringLiteral("Type %1 must be registered with Qt D-Bus "
                                    "before it can be used to read property "
@@ -205,7 +256,7 @@ QVariant DBusExtendedAbstractInterface::internalPropGet(const char *propname, vo
         }
 
         asyncProperty(propname);
-        return QVariant(metaProperty.type(), propertyPtr);
+        return QVariant(entry->userType, propertyPtr);
     }
 }
 
@@ -223,9 +274,9 @@ void DBusExtendedAbstractInterface::internalPropSet(const char *propname, const
             return;
         }
 
-        int propertyIndex = metaObject()->indexOfProperty(propname);
+        const PropertyEntry *entry = propertyEntry(propname);
 
-        if (-1 == propertyIndex) {
+        if (!entry) {
             QString errorMessage = QStringLiteral("Got unknown property \"%1\" to write")
                 .arg(QString::fromLatin1(propname));
             m_lastExtendedError = QDBusMessage::createError(QDBusError::Failed, errorMessage);
@@ -233,9 +284,7 @@ void DBusExtendedAbstractInterface::internalPropSet(const char *propname, const
             return;
         }
 
-        QMetaProperty metaProperty = metaObject()->property(propertyIndex);
-
-        if (!metaProperty.isWritable()) {
+        if (!entry->metaProperty.isWritable()) {
             QString errorMessage = QStringLiteral("Property \"%1\" is NOT writable")
                 .arg(QString::fromLatin1(propname));
             m_lastExtendedError = QDBusMessage::createError(QDBusError::Failed, errorMessage);
@@ -243,7 +292,7 @@ void DBusExtendedAbstractInterface::internalPropSet(const char *propname, const
             return;
         }
 
-        asyncSetProperty(propname, QVariant(metaProperty.type(), propertyPtr));
+        asyncSetProperty(propname, QVariant(entry->userType, propertyPtr));
     }
 }
 
@@ -276,11 +325,15 @@ void DBusExtendedAbstractInterface::onAsyncPropertyFinished(DBusExtendedPendingC
     if (reply.isError()) {
         m_lastExtendedError = reply.error();
     } else {
-        int propertyIndex = metaObject()->indexOfProperty(watcher->asyncProperty().toLatin1().constData());
-        QVariant value = demarshall(interface(),
-                                    metaObject()->property(propertyIndex),
-                                    reply.value(),
-                                    &m_lastExtendedError);
+        const PropertyEntry *entry = propertyEntry(watcher->asyncProperty());
+        QVariant value;
+        if (entry) {
+            value = demarshall(interface(), *entry, reply.value(), &m_lastExtendedError);
+        } else {
+            m_lastExtendedError = QDBusMessage::createError(QDBusError::Failed,
+                                                            QStringLiteral("Got unknown property \"%1\" to read")
+                                                            .arg(watcher->asyncProperty()));
+        }
 
         if (m_lastExtendedError.isValid()) {
             emit propertyInvalidated(watcher->asyncProperty());
@@ -343,12 +396,12 @@ void DBusExtendedAbstractInterface::onPropertiesChanged(const QString& interface
     if (interfaceName == interface()) {
         QVariantMap::const_iterator i = changedProperties.constBegin();
         while (i != changedProperties.constEnd()) {
-            int propertyIndex = metaObject()->indexOfProperty(i.key().toLatin1().constData());
+            const PropertyEntry *entry = propertyEntry(i.key());
 
-            if (-1 == propertyIndex) {
+            if (!entry) {
                 qDebug() << Q_FUNC_INFO << "Got unknown changed property" <<  i.key();
             } else {
-                QVariant value = demarshall(interface(), metaObject()->property(propertyIndex), i.value(), &m_lastExtendedError);
+                QVariant value = demarshall(interface(), *entry, i.value(), &m_lastExtendedError);
 
                 if (m_lastExtendedError.isValid()) {
                     emit propertyInvalidated(i.key());
@@ -362,7 +415,7 @@ void DBusExtendedAbstractInterface::onPropertiesChanged(const QString& interface
 
         QStringList::const_iterator j = invalidatedProperties.constBegin();
         while (j != invalidatedProperties.constEnd()) {
-            if (-1 == metaObject()->indexOfProperty(j->toLatin1().constData())) {
+            if (!propertyEntry(*j)) {
                 qDebug() << Q_FUNC_INFO << "Got unknown invalidated property" <<  *j;
             } else {
                 m_lastExtendedError = QDBusError();
@@ -374,27 +427,28 @@ void DBusExtendedAbstractInterface::onPropertiesChanged(const QString& interface
     }
 }
 
-QVariant DBusExtendedAbstractInterface::demarshall(const QString &interface, const QMetaProperty &metaProperty, const QVariant &value, QDBusError *error)
+QVariant DBusExtendedAbstractInterface::demarshall(const QString &interface, const PropertyEntry &property, const QVariant &value, QDBusError *error)
 {
+    const QMetaProperty &metaProperty = property.metaProperty;
     Q_ASSERT(metaProperty.isValid());
     Q_ASSERT(error != 0);
 
-    if (value.userType() == metaProperty.userType()) {
+    if (value.userType() == property.userType) {
         // No need demarshalling. Passing back straight away ...
         *error = QDBusError();
         return value;
     }
 
-    QVariant result = QVariant(metaProperty.userType(), (void*)0);
+    QVariant result = QVariant(property.userType, (void*)0);
     QString errorMessage;
-    const char *expectedSignature = QDBusMetaType::typeToSignature(metaProperty.userType());
+    const char *expectedSignature = property.signature.constData();
 
     if (value.userType() == qMetaTypeId<QDBusArgument>()) {
         // demarshalling a DBus argument ...
         QDBusArgument dbusArg = value.value<QDBusArgument>();
 
         if (expectedSignature == dbusArg.currentSignature().toLatin1()) {
-            QDBusMetaType::demarshall(dbusArg, metaProperty.userType(), result.data());
+            QDBusMetaType::demarshall(dbusArg, property.userType, result.data());
             if (!result.isValid()) {
                 errorMessage = QStringLiteral("Unexpected failure demarshalling "
                                               "upon PropertiesChanged signal arrival "
@@ -31,6 +31,10 @@
 #include <QDBusAbstractInterface>
 #include <QDBusError>
 
+#include <QtCore/QHash>
+#include <QtCore/QMetaProperty>
+#include <QtCore/QVector>
+
 class QDBusPendingCallWatcher;
 class DBusExtendedPendingCallWatcher;
 
@@ -80,15 +84,33 @@ private Q_SLOTS:
     void onAsyncGetAllPropertiesFinished(QDBusPendingCallWatcher *watcher);
 
 private:
+    struct PropertyEntry {
+        QMetaProperty metaProperty;
+        int userType;
+        QByteArray signature;
+    };
+
+    // Built once per proxy class, shared by all its instances
+    struct PropertyTable {
+        QVector<PropertyEntry> entries;
+        QHash<QString, int> byName;
+        QHash<QByteArray, int> byLatin1Name;
+    };
+
+    const PropertyTable *propertyTable() const;
+    const PropertyEntry *propertyEntry(const QString &propertyName) const;
+    const PropertyEntry *propertyEntry(const char *propertyName) const;
+
     QVariant asyncProperty(const QString &propertyName);
     void asyncSetProperty(const QString &propertyName, const QVariant &value);
-    static QVariant demarshall(const QString &interface, const QMetaProperty &metaProperty, const QVariant &value, QDBusError *error);
+    static QVariant demarshall(const QString &interface, const PropertyEntry &property, const QVariant &value, QDBusError *error);
 
     bool m_sync;
     bool m_useCache;
     QDBusPendingCallWatcher *m_getAllPendingCallWatcher;
     QDBusError m_lastExtendedError;
     bool m_propertiesChangedConnected;
+    mutable const PropertyTable *m_propertyTable;
 };
 
 #endif /* DBUSEXTENDEDABSTRACTINTERFACE_H */
@@ -0,0 +1,171 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bluezobjectmanager.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMetaType>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
+#include <QDBusVariant>
+#include <QDebug>
+
+#define BLUEZ_SERVICE "org.bluez"
+#define BLUEZ_ADAPTER_IFACE "org.bluez.Adapter1"
+#define DBUS_OBJECTMANAGER_IFACE "org.freedesktop.DBus.ObjectManager"
+#define DBUS_PROPERTIES_IFACE "org.freedesktop.DBus.Properties"
+
+typedef QMap<QDBusObjectPath, NMVariantMapMap> ManagedObjects;
+
+BluezObjectManager &BluezObjectManager::self()
+{
+    // Owned by the application, so it goes away together with the bus
+    // connections it uses instead of after them
+    static BluezObjectManager *m = new BluezObjectManager(qApp);
+    return *m;
+}
+
+BluezObjectManager::BluezObjectManager(QObject *parent)
+    : QObject(parent)
+    , m_serviceWatcher(new QDBusServiceWatcher(QStringLiteral(BLUEZ_SERVICE), QDBusConnection::systemBus(),
+                                               QDBusServiceWatcher::WatchForRegistration | QDBusServiceWatcher::WatchForUnregistration, this))
+    , m_ready(false)
+{
+    qDBusRegisterMetaType<NMVariantMapMap>();
+    qDBusRegisterMetaType<ManagedObjects>();
+
+    connect(m_serviceWatcher, &QDBusServiceWatcher::serviceRegistered, this, &BluezObjectManager::load);
+    connect(m_serviceWatcher, &QDBusServiceWatcher::serviceUnregistered, this, &BluezObjectManager::clear);
+
+    QDBusConnection bus = QDBusConnection::systemBus();
+    bus.connect(QStringLiteral(BLUEZ_SERVICE), QStringLiteral("/"), QStringLiteral(DBUS_OBJECTMANAGER_IFACE), QStringLiteral("InterfacesAdded"),
+                this, SLOT(onInterfacesAdded(QDBusObjectPath, NMVariantMapMap)));
+    bus.connect(QStringLiteral(BLUEZ_SERVICE), QStringLiteral("/"), QStringLiteral(DBUS_OBJECTMANAGER_IFACE), QStringLiteral("InterfacesRemoved"),
+                this, SLOT(onInterfacesRemoved(QDBusObjectPath, QStringList)));
+    // Empty path matches every object of the service, the arg0 match keeps
+    // the much chattier device property changes off the bus connection
+    bus.connect(QStringLiteral(BLUEZ_SERVICE), QString(), QStringLiteral(DBUS_PROPERTIES_IFACE), QStringLiteral("PropertiesChanged"),
+                {QStringLiteral(BLUEZ_ADAPTER_IFACE)}, QString(),
+                this, SLOT(onPropertiesChanged(QString, QVariantMap, QStringList, QDBusMessage)));
+
+    load();
+}
+
+bool BluezObjectManager::isReady() const
+{
+    return m_ready;
+}
+
+QStringList BluezObjectManager::adapters() const
+{
+    // Only adapters are mirrored
+    return m_objects.keys();
+}
+
+QVariant BluezObjectManager::property(const QString &path, const QString &interface, const QString &name) const
+{
+    return m_objects.value(path).value(interface).value(name);
+}
+
+QDBusPendingCall BluezObjectManager::setProperty(const QString &path, const QString &interface, const QString &name, const QVariant &value)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(QStringLiteral(BLUEZ_SERVICE), path, QStringLiteral(DBUS_PROPERTIES_IFACE), QStringLiteral("Set"));
+    message.setArguments({interface, name, QVariant::fromValue(QDBusVariant(value))});
+    return QDBusConnection::systemBus().asyncCall(message);
+}
+
+void BluezObjectManager::load()
+{
+    const QDBusMessage message = QDBusMessage::createMethodCall(QStringLiteral(BLUEZ_SERVICE), QStringLiteral("/"),
+                                                                QStringLiteral(DBUS_OBJECTMANAGER_IFACE), QStringLiteral("GetManagedObjects"));
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(QDBusConnection::systemBus().asyncCall(message), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, &BluezObjectManager::onManagedObjects);
+}
+
+void BluezObjectManager::clear()
+{
+    m_objects.clear();
+}
+
+void BluezObjectManager::onManagedObjects(QDBusPendingCallWatcher *watcher)
+{
+    const QDBusPendingReply<ManagedObjects> reply = *watcher;
+    watcher->deleteLater();
+
+    if (reply.isError()) {
+        // Not fatal, bluetoothd may just not be running yet
+        qDebug() << "Can't read BlueZ objects:" << reply.error().message();
+    } else {
+        const ManagedObjects objects = reply.value();
+        for (auto it = objects.constBegin(); it != objects.constEnd(); ++it) {
+            onInterfacesAdded(it.key(), it.value());
+        }
+    }
+
+    if (!m_ready) {
+        m_ready = true;
+        Q_EMIT ready();
+    }
+}
+
+void BluezObjectManager::onInterfacesAdded(const QDBusObjectPath &path, const NMVariantMapMap &interfaces)
+{
+    // Devices come and go all the time, only adapters are of interest
+    const auto adapter = interfaces.constFind(QStringLiteral(BLUEZ_ADAPTER_IFACE));
+    if (adapter == interfaces.constEnd()) {
+        return;
+    }
+
+    m_objects[path.path()].insert(adapter.key(), adapter.value());
+}
+
+void BluezObjectManager::onInterfacesRemoved(const QDBusObjectPath &path, const QStringList &interfaces)
+{
+    auto it = m_objects.find(path.path());
+    if (it == m_objects.end()) {
+        return;
+    }
+
+    for (const QString &interface : interfaces) {
+        it->remove(interface);
+    }
+
+    if (it->isEmpty()) {
+        m_objects.erase(it);
+    }
+}
+
+void BluezObjectManager::onPropertiesChanged(const QString &interface, const QVariantMap &changed, const QStringList &invalidated, const QDBusMessage &message)
+{
+    auto object = m_objects.find(message.path());
+    if (object == m_objects.end() || !object->contains(interface)) {
+        return;
+    }
+
+    QVariantMap &properties = (*object)[interface];
+
+    for (auto it = changed.constBegin(); it != changed.constEnd(); ++it) {
+        properties.insert(it.key(), it.value());
+    }
+
+    for (const QString &name : invalidated) {
+        properties.remove(name);
+    }
+}
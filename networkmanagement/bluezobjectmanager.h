@@ -0,0 +1,87 @@
+/*
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PLASMA_NM_BLUEZOBJECTMANAGER_H
+#define PLASMA_NM_BLUEZOBJECTMANAGER_H
+
+#include <QDBusMessage>
+#include <QDBusObjectPath>
+#include <QDBusPendingCall>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+#include <NetworkManagerQt/GenericTypes>
+
+class QDBusPendingCallWatcher;
+class QDBusServiceWatcher;
+
+/**
+ * Local mirror of the org.bluez object tree.
+ *
+ * Filled once from GetManagedObjects and then kept current from
+ * InterfacesAdded, InterfacesRemoved and PropertiesChanged, so reading
+ * adapter state never goes over the bus. The mirror is dropped and rebuilt
+ * when bluetoothd restarts.
+ */
+class Q_DECL_EXPORT BluezObjectManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    static BluezObjectManager &self();
+
+    /**
+     * True once the initial snapshot arrived (or bluetoothd isn't running)
+     */
+    bool isReady() const;
+
+    /**
+     * Object paths implementing org.bluez.Adapter1
+     */
+    QStringList adapters() const;
+
+    QVariant property(const QString &path, const QString &interface, const QString &name) const;
+
+    /**
+     * Issues an asynchronous Properties.Set, the mirror is updated once
+     * bluetoothd reports the change
+     */
+    QDBusPendingCall setProperty(const QString &path, const QString &interface, const QString &name, const QVariant &value);
+
+Q_SIGNALS:
+    void ready();
+
+private Q_SLOTS:
+    void onManagedObjects(QDBusPendingCallWatcher *watcher);
+    void onInterfacesAdded(const QDBusObjectPath &path, const NMVariantMapMap &interfaces);
+    void onInterfacesRemoved(const QDBusObjectPath &path, const QStringList &interfaces);
+    void onPropertiesChanged(const QString &interface, const QVariantMap &changed, const QStringList &invalidated, const QDBusMessage &message);
+
+private:
+    explicit BluezObjectManager(QObject *parent);
+
+    void load();
+    void clear();
+
+    QDBusServiceWatcher *m_serviceWatcher;
+    QHash<QString, NMVariantMapMap> m_objects;
+    bool m_ready;
+};
+
+#endif // PLASMA_NM_BLUEZOBJECTMANAGER_H
@@ -19,6 +19,7 @@
 */
 
 #include "handler.h"
+#include "bluezobjectmanager.h"
 #include "configuration.h"
 #include "uiutils.h"
 
@@ -59,6 +60,8 @@ Handler::Handler(QObject *parent)
     : QObject(parent)
     , m_tmpWirelessEnabled(NetworkManager::isWirelessEnabled())
     , m_tmpWwanEnabled(NetworkManager::isWwanEnabled())
+    , m_tmpBluetoothEnabled(false)
+    , m_bluetoothPending(false)
 {
     ::passwd *pw = ::getpwuid(::getuid());
     m_userName = QString::fromLocal8Bit(pw->pw_name);
@@ -82,6 +85,14 @@ Handler::Handler(QObject *parent)
     if (NetworkManager::checkVersion(1, 16, 0)) {
         connect(NetworkManager::notifier(), &NetworkManager::Notifier::primaryConnectionTypeChanged, this, &Handler::primaryConnectionTypeChanged);
     }
+
+    // Starts mirroring BlueZ objects now so airplane mode doesn't have to wait for it
+    connect(&BluezObjectManager::self(), &BluezObjectManager::ready, this, [this]() {
+        if (m_bluetoothPending) {
+            m_bluetoothPending = false;
+            enableBluetooth(m_tmpBluetoothEnabled);
+        }
+    });
 }
 
 Handler::~Handler()
@@ -380,65 +391,29 @@ void Handler::enableAirplaneMode(bool enable)
     }
 }
 
-template<typename T>
-void makeDBusCall(const QDBusMessage &message, QObject *context, std::function<void(QDBusPendingReply<T>)> func)
-{
-    QDBusPendingReply<T> reply = QDBusConnection::systemBus().asyncCall(message);
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, context);
-    QObject::connect(watcher, &QDBusPendingCallWatcher::finished, context, [func] (QDBusPendingCallWatcher *watcher) {
-        const QDBusPendingReply<T> reply = *watcher;
-        if (!reply.isValid()) {
-            qWarning() << reply.error().message();
-            return;
-        }
-        func(reply);
-        watcher->deleteLater();
-    });
-}
-
-void setBluetoothEnabled(QString path, bool enabled)
-{
-    QDBusMessage message = QDBusMessage::createMethodCall("org.bluez", path, "org.freedesktop.DBus.Properties", "Set");
-    QList<QVariant> arguments;
-    arguments << QLatin1String("org.bluez.Adapter1");
-    arguments << QLatin1String("Powered");
-    arguments << QVariant::fromValue(QDBusVariant(QVariant(enabled)));
-    message.setArguments(arguments);
-    QDBusConnection::systemBus().asyncCall(message);
-}
-
 void Handler::enableBluetooth(bool enable)
 {
-    qDBusRegisterMetaType< QMap<QDBusObjectPath, NMVariantMapMap > >();
+    BluezObjectManager &bluez = BluezObjectManager::self();
 
-    const QDBusMessage getObjects = QDBusMessage::createMethodCall("org.bluez", "/", "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+    // The object mirror is still being filled, the last request is applied once it's ready
+    if (!bluez.isReady()) {
+        m_bluetoothPending = true;
+        m_tmpBluetoothEnabled = enable;
+        return;
+    }
 
-    makeDBusCall<QMap<QDBusObjectPath, NMVariantMapMap>>(getObjects, this, [enable, this](const auto reply) {
-        for (const QDBusObjectPath &path : reply.value().keys()) {
-            const QString objPath = path.path();
-            qDebug() << "inspecting path" << objPath;
-            const QStringList interfaces = reply.value().value(path).keys();
-            qDebug() << "interfaces:" << interfaces;
+    const QString adapterInterface = QStringLiteral("org.bluez.Adapter1");
+    const QString powered = QStringLiteral("Powered");
 
-            if (!interfaces.contains("org.bluez.Adapter1")) {
-                continue;
-            }
-
-            // We need to check previous state first
-            if (!enable) {
-                QDBusMessage getPowered = QDBusMessage::createMethodCall("org.bluez", objPath, "org.freedesktop.DBus.Properties", "Get");
-                const QList<QVariant> arguments { QLatin1String("org.bluez.Adapter1"), QLatin1String("Powered") };
-                getPowered.setArguments(arguments);
-
-                makeDBusCall<QVariant>(getPowered, this, [objPath, this](const auto reply){
-                    m_bluetoothAdapters.insert(objPath, reply.value().toBool());
-                    setBluetoothEnabled(objPath, false);
-                });
-            } else if (m_bluetoothAdapters.value(objPath)) {
-                setBluetoothEnabled(objPath, true);
-            }
+    // Every Set is sent at once, previous states come from the mirror
+    for (const QString &path : bluez.adapters()) {
+        if (!enable) {
+            m_bluetoothAdapters.insert(path, bluez.property(path, adapterInterface, powered).toBool());
+            bluez.setProperty(path, adapterInterface, powered, false);
+        } else if (m_bluetoothAdapters.value(path)) {
+            bluez.setProperty(path, adapterInterface, powered, true);
         }
-    });
+    }
 }
 
 void Handler::enableNetworking(bool enable)
@@ -143,6 +143,8 @@ private:
     bool m_hotspotSupported;
     bool m_tmpWirelessEnabled;
     bool m_tmpWwanEnabled;
+    bool m_tmpBluetoothEnabled;
+    bool m_bluetoothPending;
 #if WITH_MODEMMANAGER_SUPPORT
     QString m_tmpConnectionPath;
 #endif
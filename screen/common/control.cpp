@@ -131,33 +131,55 @@ ControlConfig::ControlConfig(KScreen::ConfigPtr config, QObject *parent)
 
     // As global outputs are indexed by a hash of their edid, which is not unique,
     // to be able to tell apart multiple identical outputs, these need special treatment
-    QStringList allIds;
     const auto outputs = config->outputs();
-    allIds.reserve(outputs.count());
     for (const KScreen::OutputPtr &output : outputs) {
-        const auto outputId = output->hashMd5();
-        if (allIds.contains(outputId) && !m_duplicateOutputIds.contains(outputId)) {
-            m_duplicateOutputIds << outputId;
-        }
-        allIds << outputId;
+        addOutput(output);
     }
 
-    for (auto output : outputs) {
-        m_outputsControls << new ControlOutput(output, this);
+    // TODO: this is same in Output::readInOutputs of the daemon. Combine?
+}
+
+void ControlConfig::addOutput(const KScreen::OutputPtr &output)
+{
+    for (auto *control : qAsConst(m_outputsControls)) {
+        if (control->outputId() == output->id()) {
+            return;
+        }
     }
+    m_outputIdCounts[output->hashMd5()]++;
 
-    // TODO: this is same in Output::readInOutputs of the daemon. Combine?
+    auto *control = new ControlOutput(output, this);
+    m_outputsControls << control;
+    if (m_watcherActive) {
+        control->activateWatcher();
+        connect(control, &ControlOutput::changed, this, &ControlConfig::changed);
+    }
+}
 
-    // TODO: connect to outputs added/removed signals and reevaluate duplicate ids
-    //       in case of such a change while object exists?
+void ControlConfig::removeOutput(int outputId)
+{
+    for (int i = 0; i < m_outputsControls.size(); i++) {
+        auto *control = m_outputsControls[i];
+        if (control->outputId() != outputId) {
+            continue;
+        }
+        auto it = m_outputIdCounts.find(control->id());
+        if (it != m_outputIdCounts.end() && --it.value() <= 0) {
+            m_outputIdCounts.erase(it);
+        }
+        m_outputsControls.remove(i);
+        control->deleteLater();
+        return;
+    }
 }
 
 void ControlConfig::activateWatcher()
 {
-    if (watcher()) {
+    if (m_watcherActive) {
         // Watcher was already activated.
         return;
     }
+    m_watcherActive = true;
     for (auto *output : m_outputsControls) {
         output->activateWatcher();
         connect(output, &ControlOutput::changed, this, &ControlConfig::changed);
@@ -199,7 +221,7 @@ bool ControlConfig::infoIsOutput(const QVariantMap &info, const QString &outputI
         return false;
     }
 
-    if (!outputName.isEmpty() && m_duplicateOutputIds.contains(outputId)) {
+    if (!outputName.isEmpty() && m_outputIdCounts.value(outputId) > 1) {
         // We may have identical outputs connected, these will have the same id in the config
         // in order to find the right one, also check the output's name (usually the connector)
         const auto metadata = info[QStringLiteral("metadata")].toMap();
@@ -573,6 +595,11 @@ QString ControlOutput::name() const
     return m_output->name();
 }
 
+int ControlOutput::outputId() const
+{
+    return m_output->id();
+}
+
 QString ControlOutput::dirPath() const
 {
     return Control::dirPath() % QStringLiteral("outputs/");
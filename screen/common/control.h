@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <kscreen/types.h>
 
+#include <QHash>
 #include <QObject>
 #include <QVariantMap>
 #include <QVector>
@@ -72,6 +73,13 @@ class ControlConfig : public Control
 public:
     explicit ControlConfig(KScreen::ConfigPtr config, QObject *parent = nullptr);
 
+    /**
+     * Keeps the output controls in sync with hotplugged outputs. Identical outputs
+     * are told apart by name, so duplicate ids are re-evaluated on each call.
+     */
+    void addOutput(const KScreen::OutputPtr &output);
+    void removeOutput(int outputId);
+
     OutputRetention getOutputRetention(const KScreen::OutputPtr &output) const;
     OutputRetention getOutputRetention(const QString &outputId, const QString &outputName) const;
     void setOutputRetention(const KScreen::OutputPtr &output, OutputRetention value);
@@ -110,8 +118,9 @@ private:
     ControlOutput *getOutputControl(const QString &outputId, const QString &outputName) const;
 
     KScreen::ConfigPtr m_config;
-    QStringList m_duplicateOutputIds;
+    QHash<QString, int> m_outputIdCounts;
     QVector<ControlOutput *> m_outputsControls;
+    bool m_watcherActive = false;
 };
 
 class ControlOutput : public Control
@@ -122,6 +131,7 @@ public:
 
     QString id() const;
     QString name() const;
+    int outputId() const;
 
     // TODO: scale auto value
 
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2021 CutefishOS Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profiles.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QStringBuilder>
+
+#include <kscreen/config.h>
+#include <kscreen/output.h>
+
+ControlProfiles::ControlProfiles(QObject *parent)
+    : Control(parent)
+{
+    readFile();
+    rebuildIndex();
+}
+
+QString ControlProfiles::filePath() const
+{
+    return dirPath() % QStringLiteral("profiles");
+}
+
+bool ControlProfiles::writeFile()
+{
+    const auto infoMap = constInfo();
+    if (infoMap.isEmpty()) {
+        QFile::remove(filePath());
+        return true;
+    }
+    if (!QDir().mkpath(dirPath())) {
+        return false;
+    }
+
+    QFile file(filePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    // Profiles of every output combination ever seen end up in this file,
+    // so keep it compact.
+    file.write(QJsonDocument::fromVariant(infoMap).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+bool ControlProfiles::hasProfile(const QString &configHash) const
+{
+    return m_profiles.contains(configHash);
+}
+
+void ControlProfiles::rebuildIndex()
+{
+    m_profiles.clear();
+
+    const auto &infoMap = constInfo();
+    for (auto it = infoMap.constBegin(); it != infoMap.constEnd(); ++it) {
+        Profile profile;
+        const QVariantList outputsInfo = it.value().toList();
+        profile.reserve(outputsInfo.count());
+
+        for (const auto &variantInfo : outputsInfo) {
+            const QVariantMap info = variantInfo.toMap();
+            const QVariantMap pos = info[QStringLiteral("pos")].toMap();
+
+            OutputProfile output;
+            output.id = info[QStringLiteral("id")].toString();
+            output.name = info[QStringLiteral("name")].toString();
+            output.enabled = info[QStringLiteral("enabled")].toBool();
+            output.primary = info[QStringLiteral("primary")].toBool();
+            output.modeId = info[QStringLiteral("mode")].toString();
+            output.pos = QPoint(pos[QStringLiteral("x")].toInt(), pos[QStringLiteral("y")].toInt());
+            output.rotation = info.value(QStringLiteral("rotation"), static_cast<int>(KScreen::Output::None)).toInt();
+            output.scale = info.value(QStringLiteral("scale"), 1.0).toReal();
+            output.replicateHash = info[QStringLiteral("replicate-hash")].toString();
+            output.replicateName = info[QStringLiteral("replicate-name")].toString();
+
+            if (!output.id.isEmpty()) {
+                profile << output;
+            }
+        }
+        if (!profile.isEmpty()) {
+            m_profiles.insert(it.key(), profile);
+        }
+    }
+}
+
+void ControlProfiles::storeProfile(const KScreen::ConfigPtr &config)
+{
+    const auto outputs = config->connectedOutputs();
+    if (outputs.isEmpty()) {
+        return;
+    }
+
+    Profile profile;
+    QVariantList outputsInfo;
+    profile.reserve(outputs.count());
+
+    for (const KScreen::OutputPtr &output : outputs) {
+        OutputProfile outputProfile;
+        outputProfile.id = output->hashMd5();
+        outputProfile.name = output->name();
+        outputProfile.enabled = output->isEnabled();
+        outputProfile.primary = output->isPrimary();
+        outputProfile.modeId = output->currentModeId();
+        outputProfile.pos = output->pos();
+        outputProfile.rotation = output->rotation();
+        outputProfile.scale = output->scale();
+
+        const int sourceId = output->replicationSource();
+        if (sourceId) {
+            if (const auto source = config->output(sourceId)) {
+                outputProfile.replicateHash = source->hashMd5();
+                outputProfile.replicateName = source->name();
+            }
+        }
+        profile << outputProfile;
+
+        QVariantMap pos;
+        pos[QStringLiteral("x")] = outputProfile.pos.x();
+        pos[QStringLiteral("y")] = outputProfile.pos.y();
+
+        QVariantMap outputInfo;
+        outputInfo[QStringLiteral("id")] = outputProfile.id;
+        outputInfo[QStringLiteral("name")] = outputProfile.name;
+        outputInfo[QStringLiteral("enabled")] = outputProfile.enabled;
+        outputInfo[QStringLiteral("primary")] = outputProfile.primary;
+        outputInfo[QStringLiteral("mode")] = outputProfile.modeId;
+        outputInfo[QStringLiteral("pos")] = pos;
+        outputInfo[QStringLiteral("rotation")] = outputProfile.rotation;
+        outputInfo[QStringLiteral("scale")] = outputProfile.scale;
+        if (!outputProfile.replicateHash.isEmpty()) {
+            outputInfo[QStringLiteral("replicate-hash")] = outputProfile.replicateHash;
+            outputInfo[QStringLiteral("replicate-name")] = outputProfile.replicateName;
+        }
+        outputsInfo << outputInfo;
+    }
+
+    const QString hash = config->connectedOutputsHash();
+    info()[hash] = outputsInfo;
+    m_profiles.insert(hash, profile);
+}
+
+static KScreen::OutputPtr findOutput(const KScreen::OutputList &outputs, const QString &id, const QString &name)
+{
+    KScreen::OutputPtr candidate;
+    for (const KScreen::OutputPtr &output : outputs) {
+        if (output->hashMd5() != id) {
+            continue;
+        }
+        if (output->name() == name) {
+            return output;
+        }
+        // Same monitor, but maybe plugged into another connector of the dock.
+        if (!candidate) {
+            candidate = output;
+        }
+    }
+    return candidate;
+}
+
+bool ControlProfiles::applyProfile(const KScreen::ConfigPtr &config) const
+{
+    const auto it = m_profiles.constFind(config->connectedOutputsHash());
+    if (it == m_profiles.constEnd()) {
+        return false;
+    }
+
+    const auto outputs = config->connectedOutputs();
+
+    for (const OutputProfile &outputProfile : *it) {
+        auto output = findOutput(outputs, outputProfile.id, outputProfile.name);
+        if (!output) {
+            continue;
+        }
+        output->setEnabled(outputProfile.enabled);
+        if (!outputProfile.enabled) {
+            continue;
+        }
+        if (output->modes().contains(outputProfile.modeId)) {
+            output->setCurrentModeId(outputProfile.modeId);
+        }
+        output->setPos(outputProfile.pos);
+        output->setRotation(static_cast<KScreen::Output::Rotation>(outputProfile.rotation));
+        output->setScale(outputProfile.scale);
+
+        if (outputProfile.primary) {
+            config->setPrimaryOutput(output);
+        }
+    }
+
+    // Clones take the geometry of their source, so they are set up once
+    // every source has its final position.
+    for (const OutputProfile &outputProfile : *it) {
+        auto output = findOutput(outputs, outputProfile.id, outputProfile.name);
+        if (!output) {
+            continue;
+        }
+        auto source = outputProfile.replicateHash.isEmpty() ? KScreen::OutputPtr()
+                                                            : findOutput(outputs, outputProfile.replicateHash, outputProfile.replicateName);
+        if (!source || output == source) {
+            output->setReplicationSource(0);
+            continue;
+        }
+        output->setReplicationSource(source->id());
+        output->setPos(source->pos());
+        output->setExplicitLogicalSize(source->explicitLogicalSize());
+    }
+    return true;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2021 CutefishOS Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMON_PROFILES_H
+#define COMMON_PROFILES_H
+
+#include "control.h"
+
+#include <kscreen/output.h>
+
+#include <QHash>
+#include <QPoint>
+
+/**
+ * Full layout profiles (modes, positions, primary, replication) for every
+ * combination of connected outputs seen so far, keyed by
+ * KScreen::Config::connectedOutputsHash().
+ *
+ * All profiles live in a single compact JSON file. It is read once and
+ * indexed in memory, so matching a freshly connected set of outputs is a
+ * hash lookup and does not touch the disk.
+ */
+class ControlProfiles : public Control
+{
+    Q_OBJECT
+public:
+    explicit ControlProfiles(QObject *parent = nullptr);
+
+    bool hasProfile(const QString &configHash) const;
+
+    /**
+     * Stores the current layout of all connected outputs of @p config
+     * as the profile for its connected outputs hash.
+     */
+    void storeProfile(const KScreen::ConfigPtr &config);
+
+    /**
+     * Applies the stored profile matching @p config to it, including the
+     * replication source of cloned outputs.
+     *
+     * @return false if there is no profile for the connected outputs of @p config.
+     */
+    bool applyProfile(const KScreen::ConfigPtr &config) const;
+
+    QString filePath() const override;
+
+    bool writeFile() override;
+
+private:
+    struct OutputProfile {
+        QString id;
+        QString name;
+        bool enabled = false;
+        bool primary = false;
+        QString modeId;
+        QPoint pos;
+        int rotation = KScreen::Output::None;
+        qreal scale = 1.0;
+        QString replicateHash;
+        QString replicateName;
+    };
+    using Profile = QVector<OutputProfile>;
+
+    void rebuildIndex();
+
+    QHash<QString, Profile> m_profiles;
+};
+
+#endif
@@ -59,10 +59,19 @@ void ConfigHandler::setConfig(KScreen::ConfigPtr config)
         checkNeedsSave();
         Q_EMIT changed();
     });
-    connect(m_config.data(), &KScreen::Config::outputAdded, this, [this]() {
+    // Hotplug only touches the affected rows and output controls,
+    // the model itself stays alive so QML keeps its other delegates.
+    connect(m_config.data(), &KScreen::Config::outputAdded, this, [this](const KScreen::OutputPtr &output) {
+        m_control->addOutput(output);
+        initOutput(output);
+        checkScreenNormalization();
         Q_EMIT outputConnect(true);
     });
-    connect(m_config.data(), &KScreen::Config::outputRemoved, this, [this]() {
+    connect(m_config.data(), &KScreen::Config::outputRemoved, this, [this](int outputId) {
+        disconnect(m_outputConnections.take(outputId));
+        m_outputs->remove(outputId);
+        m_control->removeOutput(outputId);
+        checkScreenNormalization();
         Q_EMIT outputConnect(false);
     });
     // connect(m_config.data(), &KScreen::Config::primaryOutputChanged, this, &ConfigHandler::primaryOutputChanged);
@@ -91,7 +100,22 @@ void ConfigHandler::initOutput(const KScreen::OutputPtr &output)
         resetScale(output);
         m_outputs->add(output);
     }
-    connect(output.data(), &KScreen::Output::isConnectedChanged, this, [this, output]() {
+    // One connection per output id, a re-added output replaces the old one.
+    // The lambda must not own the output it is stored on.
+    disconnect(m_outputConnections.take(output->id()));
+    const QWeakPointer<KScreen::Output> weakOutput = output;
+    m_outputConnections[output->id()] = connect(output.data(), &KScreen::Output::isConnectedChanged, this, [this, weakOutput]() {
+        const KScreen::OutputPtr output = weakOutput.toStrongRef();
+        if (!output) {
+            return;
+        }
+        if (output->isConnected()) {
+            resetScale(output);
+            m_outputs->add(output);
+        } else {
+            m_outputs->remove(output->id());
+        }
+        checkScreenNormalization();
         Q_EMIT outputConnect(output->isConnected());
     });
 }
@@ -22,6 +22,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <kscreen/config.h>
 
+#include <QHash>
+
 #include <memory>
 
 class OutputModel;
@@ -94,6 +96,7 @@ private:
 
     std::unique_ptr<ControlConfig> m_control;
     std::unique_ptr<ControlConfig> m_initialControl;
+    QHash<int, QMetaObject::Connection> m_outputConnections;
     Control::OutputRetention m_initialRetention = Control::OutputRetention::Undefined;
     QSize m_lastNormalizedScreenSize;
 };
@@ -199,8 +199,11 @@ QHash<int, QByteArray> OutputModel::roleNames() const
 
 void OutputModel::add(const KScreen::OutputPtr &output)
 {
-    const int insertPos = m_outputs.count();
-    Q_EMIT beginInsertRows(QModelIndex(), insertPos, insertPos);
+    for (const Output &out : qAsConst(m_outputs)) {
+        if (out.ptr->id() == output->id()) {
+            return;
+        }
+    }
 
     int i = 0;
     while (i < m_outputs.size()) {
@@ -221,6 +224,7 @@ void OutputModel::add(const KScreen::OutputPtr &output)
         const QPoint delta = m_outputs[0].pos - m_outputs[0].ptr->pos();
         pos = output->pos() + delta;
     }
+    Q_EMIT beginInsertRows(QModelIndex(), i, i);
     m_outputs.insert(i, Output(output, pos));
 
     connect(output.data(), &KScreen::Output::priorityChanged,
@@ -250,9 +254,18 @@ void OutputModel::remove(int outputId)
     });
     if (it != m_outputs.end()) {
         const int index = it - m_outputs.begin();
+        disconnect(it->ptr.data(), &KScreen::Output::priorityChanged, this, nullptr);
         Q_EMIT beginRemoveRows(QModelIndex(), index, index);
         m_outputs.erase(it);
         Q_EMIT endRemoveRows();
+
+        // Update replications of the remaining outputs.
+        for (int j = 0; j < m_outputs.size(); j++) {
+            QModelIndex modelIndex = createIndex(j, 0);
+            Q_EMIT dataChanged(modelIndex, modelIndex, {ReplicationSourceModelRole,
+                                                        ReplicationSourceIndexRole,
+                                                        ReplicasModelRole});
+        }
     }
 }
 
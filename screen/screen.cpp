@@ -3,13 +3,23 @@
 
 #include <kscreen/setconfigoperation.h>
 
+#include <QElapsedTimer>
+#include <QLoggingCategory>
 #include <QQmlExtensionPlugin>
 #include <QQmlEngine>
 
+Q_LOGGING_CATEGORY(gLcScreen, "cutefish.screen", QtInfoMsg)
+
 Screen::Screen(QObject *parent)
     : QObject(parent)
+    , m_profiles(new ControlProfiles)
 {
     qmlRegisterType<OutputModel>();
+
+    m_profileTimer.setSingleShot(true);
+    m_profileTimer.setInterval(50);
+    connect(&m_profileTimer, &QTimer::timeout, this, &Screen::restoreProfile);
+
     load();
 }
 
@@ -27,6 +37,10 @@ void Screen::load()
 
     m_config.reset(new ConfigHandler(this));
     connect(m_config.get(), &ConfigHandler::outputModelChanged, this, &Screen::outputModelChanged);
+    connect(m_config.get(), &ConfigHandler::outputConnect, this, [this](bool connected) {
+        Q_UNUSED(connected)
+        m_profileTimer.start();
+    });
 
     connect(new KScreen::GetConfigOperation(), &KScreen::GetConfigOperation::finished, this, &Screen::configReady);
 }
@@ -46,6 +60,9 @@ void Screen::save()
 
     m_config->writeControl();
 
+    m_profiles->storeProfile(config);
+    m_profiles->writeFile();
+
     auto *op = new KScreen::SetConfigOperation(config);
     op->exec();
 }
@@ -71,3 +88,88 @@ void Screen::configReady(KScreen::ConfigOperation *op)
 
     m_config->setConfig(config);
 }
+
+static bool sameLayout(const KScreen::ConfigPtr &a, const KScreen::ConfigPtr &b)
+{
+    const auto outputs = a->outputs();
+    for (const KScreen::OutputPtr &output : outputs) {
+        const KScreen::OutputPtr other = b->output(output->id());
+        if (!other || output->isConnected() != other->isConnected()) {
+            return false;
+        }
+        if (!output->isConnected()) {
+            continue;
+        }
+        if (output->isEnabled() != other->isEnabled()
+            || output->isPrimary() != other->isPrimary()
+            || output->replicationSource() != other->replicationSource()) {
+            return false;
+        }
+        if (output->isEnabled()
+            && (output->currentModeId() != other->currentModeId()
+                || output->pos() != other->pos()
+                || output->rotation() != other->rotation()
+                || !qFuzzyCompare(output->scale(), other->scale()))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Screen::restoreProfile()
+{
+    if (!m_config || !m_config->config()) {
+        return;
+    }
+    if (m_applyingProfile) {
+        // Picked up again once the running operation finished
+        m_profilePending = true;
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Apply the whole profile to a copy, so the model only sees the final
+    // layout once the backend reports it back, instead of reflowing per output.
+    KScreen::ConfigPtr config = m_config->config()->clone();
+    if (!m_profiles->applyProfile(config)) {
+        return;
+    }
+    const qint64 matchTime = timer.nsecsElapsed();
+
+    // Reconnecting the same outputs usually brings back the same layout,
+    // don't trigger a mode set for nothing
+    if (sameLayout(config, m_config->config())) {
+        storeReplication(config);
+        return;
+    }
+
+    m_applyingProfile = true;
+    auto *op = new KScreen::SetConfigOperation(config);
+    connect(op, &KScreen::SetConfigOperation::finished, this, [this, config, timer, matchTime](KScreen::ConfigOperation *operation) {
+        m_applyingProfile = false;
+        if (m_profilePending) {
+            m_profilePending = false;
+            m_profileTimer.start();
+        }
+        if (operation->hasError()) {
+            qCWarning(gLcScreen) << "Failed to restore display profile:" << operation->errorString();
+            return;
+        }
+        storeReplication(config);
+        qCInfo(gLcScreen) << "Restored display profile, match:" << matchTime / 1000 << "us, apply:" << timer.elapsed() << "ms";
+    });
+}
+
+void Screen::storeReplication(const KScreen::ConfigPtr &config)
+{
+    if (!m_config) {
+        return;
+    }
+
+    // The OutputModel reads replication from the control file, not from KScreen
+    for (KScreen::OutputPtr output : config->connectedOutputs()) {
+        m_config->setReplicationSource(output, config->output(output->replicationSource()));
+    }
+}
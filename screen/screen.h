@@ -1,11 +1,13 @@
 #pragma once
 
 #include <QObject>
+#include <QTimer>
 #include <memory>
 #include <kscreen/getconfigoperation.h>
 
 #include "confighandler.h"
 #include "outputmodel.h"
+#include "./common/profiles.h"
 
 class ConfigHandler;
 class OutputModel;
@@ -24,10 +26,20 @@ public:
 
 private:
     void configReady(KScreen::ConfigOperation *op);
+    void restoreProfile();
+    void storeReplication(const KScreen::ConfigPtr &config);
 
 Q_SIGNALS:
     void outputModelChanged();
 
 private:
     std::unique_ptr<ConfigHandler> m_config;
-};
\ No newline at end of file
+    std::unique_ptr<ControlProfiles> m_profiles;
+
+    // Outputs of a docking station show up one by one,
+    // restore the profile once for all of them.
+    QTimer m_profileTimer;
+    bool m_applyingProfile = false;
+    // Hotplug seen while a profile was being applied
+    bool m_profilePending = false;
+};